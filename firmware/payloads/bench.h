@@ -0,0 +1,14 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+/* Maximum number of HARTs (including the boot HART) used by the benchmark */
+#define BENCH_MAX_HARTS		8
+
+/* Each HART gets a (1 << BENCH_STACK_SHIFT) bytes stack */
+#define BENCH_STACK_SHIFT	13
+
+#endif
@@ -0,0 +1,575 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Simple S-mode payload which measures the cost (in cycles) of common
+ * SBI calls and trap-and-emulate paths of the underlying firmware. It also
+ * checks how an overflow of a firmware PMU counter is reported.
+ */
+
+#include <libfdt.h>
+#include <sbi/riscv_asm.h>
+#include <sbi/riscv_encoding.h>
+#include <sbi/sbi_bitops.h>
+#include <sbi/sbi_ecall_interface.h>
+#include <sbi/sbi_string.h>
+#include <sbi/sbi_types.h>
+#include "bench.h"
+
+/* Number of measured samples (after warm-up) for each operation */
+#define BENCH_SAMPLES		256
+#define BENCH_WARMUP		16
+
+/* Length of the strings and bits of the HART mask used by core primitives */
+#define BENCH_STR_LEN		256
+#define BENCH_MASK_BITS		256
+
+/* Column widths of the report */
+#define BENCH_NAME_WIDTH	32
+#define BENCH_NUM_WIDTH		10
+
+#if __riscv_xlen == 64
+#define BENCH_REG_L		"ld"
+#define BENCH_REG_S		"sd"
+#else
+#define BENCH_REG_L		"lw"
+#define BENCH_REG_S		"sw"
+#endif
+
+struct sbiret {
+	long error;
+	long value;
+};
+
+static inline struct sbiret sbi_ecall(unsigned long ext, unsigned long fid,
+				      unsigned long arg0, unsigned long arg1,
+				      unsigned long arg2, unsigned long arg3,
+				      unsigned long arg4)
+{
+	struct sbiret ret;
+	register unsigned long a0 asm("a0") = arg0;
+	register unsigned long a1 asm("a1") = arg1;
+	register unsigned long a2 asm("a2") = arg2;
+	register unsigned long a3 asm("a3") = arg3;
+	register unsigned long a4 asm("a4") = arg4;
+	register unsigned long a6 asm("a6") = fid;
+	register unsigned long a7 asm("a7") = ext;
+
+	asm volatile("ecall"
+		     : "+r"(a0), "+r"(a1)
+		     : "r"(a2), "r"(a3), "r"(a4), "r"(a6), "r"(a7)
+		     : "memory");
+	ret.error = a0;
+	ret.value = a1;
+
+	return ret;
+}
+
+#define sbi_ecall_0(__eid, __fid) \
+	sbi_ecall(__eid, __fid, 0, 0, 0, 0, 0)
+#define sbi_ecall_2(__eid, __fid, __a0, __a1) \
+	sbi_ecall(__eid, __fid, __a0, __a1, 0, 0, 0)
+#define sbi_ecall_3(__eid, __fid, __a0, __a1, __a2) \
+	sbi_ecall(__eid, __fid, __a0, __a1, __a2, 0, 0)
+#define sbi_ecall_4(__eid, __fid, __a0, __a1, __a2, __a3) \
+	sbi_ecall(__eid, __fid, __a0, __a1, __a2, __a3, 0)
+
+#define wfi()                                             \
+	do {                                              \
+		__asm__ __volatile__("wfi" ::: "memory"); \
+	} while (0)
+
+static void bench_puts(const char *str)
+{
+	unsigned long len = 0;
+	struct sbiret ret;
+
+	while (str && str[len])
+		len++;
+
+	/* Write the string with DBCN if available, which may write less */
+	while (len) {
+		ret = sbi_ecall_3(SBI_EXT_DBCN, SBI_EXT_DBCN_CONSOLE_WRITE,
+				  len, (unsigned long)str, 0);
+		if (ret.error || !ret.value)
+			break;
+		str += ret.value;
+		len -= ret.value;
+	}
+	if (!len)
+		return;
+
+	while (str && *str)
+		sbi_ecall_2(SBI_EXT_0_1_CONSOLE_PUTCHAR, 0, *str++, 0);
+}
+
+/* Append a string, left-aligned and padded to width, to buf at pos */
+static int bench_fmt_str(char *buf, int pos, const char *str, int width)
+{
+	int len = 0;
+
+	while (str[len])
+		buf[pos++] = str[len++];
+	while (len++ < width)
+		buf[pos++] = ' ';
+	buf[pos] = '\0';
+
+	return pos;
+}
+
+/* Append a decimal number, right-aligned and padded to width, to buf at pos */
+static int bench_fmt_num(char *buf, int pos, unsigned long val, int width)
+{
+	char tmp[24];
+	int len = 0;
+
+	do {
+		tmp[len++] = '0' + (val % 10);
+		val /= 10;
+	} while (val);
+	while (width-- > len)
+		buf[pos++] = ' ';
+	while (len)
+		buf[pos++] = tmp[--len];
+	buf[pos] = '\0';
+
+	return pos;
+}
+
+static unsigned long boot_hartid;
+static unsigned long bench_hartids[BENCH_MAX_HARTS];
+static unsigned long bench_hart_count;
+static unsigned long bench_secondaries_online;
+static unsigned long bench_samples[BENCH_SAMPLES];
+static unsigned long bench_buf[2];
+
+extern char _start_secondary[];
+
+void bench_secondary_main(unsigned long hartid, unsigned long slot)
+{
+	/* Wake up from WFI on S-mode IPIs without taking the trap */
+	csr_set(CSR_SIE, SIP_SSIP);
+	__atomic_fetch_add(&bench_secondaries_online, 1, __ATOMIC_RELEASE);
+
+	/*
+	 * Remote fences are completed by the firmware while we sit in
+	 * WFI. S-mode IPIs are echoed back to the boot HART.
+	 */
+	while (1) {
+		wfi();
+		if (!(csr_read(CSR_SIP) & SIP_SSIP))
+			continue;
+		csr_clear(CSR_SIP, SIP_SSIP);
+		sbi_ecall_2(SBI_EXT_IPI, SBI_EXT_IPI_SEND_IPI, 1, boot_hartid);
+	}
+}
+
+static void bench_start_secondaries(void)
+{
+	unsigned long hartid;
+	struct sbiret ret;
+
+	bench_hartids[0] = boot_hartid;
+	bench_hart_count = 1;
+
+	/* HART masks below use base 0 so only probe HARTs that fit in one */
+	for (hartid = 0; hartid < __riscv_xlen; hartid++) {
+		if (bench_hart_count == BENCH_MAX_HARTS)
+			break;
+		if (hartid == boot_hartid)
+			continue;
+
+		ret = sbi_ecall_2(SBI_EXT_HSM, SBI_EXT_HSM_HART_GET_STATUS,
+				  hartid, 0);
+		if (ret.error || ret.value != SBI_HSM_STATE_STOPPED)
+			continue;
+
+		ret = sbi_ecall_3(SBI_EXT_HSM, SBI_EXT_HSM_HART_START, hartid,
+				  (unsigned long)_start_secondary,
+				  bench_hart_count);
+		if (ret.error)
+			continue;
+
+		bench_hartids[bench_hart_count++] = hartid;
+	}
+
+	while (__atomic_load_n(&bench_secondaries_online, __ATOMIC_ACQUIRE) !=
+	       bench_hart_count - 1)
+		;
+}
+
+static void bench_report(const char *name)
+{
+	unsigned long i, j, val;
+	char line[96];
+	int pos;
+
+	/* Insertion sort is good enough for a few hundred samples */
+	for (i = 1; i < BENCH_SAMPLES; i++) {
+		val = bench_samples[i];
+		for (j = i; j > 0 && bench_samples[j - 1] > val; j--)
+			bench_samples[j] = bench_samples[j - 1];
+		bench_samples[j] = val;
+	}
+
+	pos = bench_fmt_str(line, 0, name, BENCH_NAME_WIDTH);
+	pos = bench_fmt_num(line, pos, bench_samples[0], BENCH_NUM_WIDTH);
+	pos = bench_fmt_num(line, pos, bench_samples[BENCH_SAMPLES / 2],
+			    BENCH_NUM_WIDTH);
+	pos = bench_fmt_num(line, pos,
+			    bench_samples[(BENCH_SAMPLES * 99) / 100],
+			    BENCH_NUM_WIDTH);
+	bench_fmt_str(line, pos, "\n", 0);
+	bench_puts(line);
+}
+
+static void bench_run(const char *name, void (*fn)(const void *arg),
+		      const void *arg)
+{
+	unsigned long i, start, end;
+
+	for (i = 0; i < BENCH_WARMUP + BENCH_SAMPLES; i++) {
+		start = csr_read(CSR_CYCLE);
+		fn(arg);
+		end = csr_read(CSR_CYCLE);
+		if (i >= BENCH_WARMUP)
+			bench_samples[i - BENCH_WARMUP] = end - start;
+	}
+
+	bench_report(name);
+}
+
+static void bench_empty(const void *arg)
+{
+	asm volatile("" ::: "memory");
+}
+
+static void bench_null_ecall(const void *arg)
+{
+	sbi_ecall_0(SBI_EXT_BASE, SBI_EXT_BASE_GET_SPEC_VERSION);
+}
+
+static void bench_set_timer(const void *arg)
+{
+	/* Far enough in the future to never fire (RV32 passes hi in a1) */
+	sbi_ecall_2(SBI_EXT_TIME, SBI_EXT_TIME_SET_TIMER, -1UL, -1UL);
+}
+
+static void bench_rdtime(const void *arg)
+{
+	csr_read(CSR_TIME);
+}
+
+static void bench_misaligned_load(const void *arg)
+{
+	unsigned long val;
+
+	asm volatile(BENCH_REG_L " %0, 0(%1)"
+		     : "=r"(val)
+		     : "r"((char *)bench_buf + 1)
+		     : "memory");
+}
+
+static void bench_misaligned_store(const void *arg)
+{
+	asm volatile(BENCH_REG_S " %0, 0(%1)"
+		     :
+		     : "r"(0UL), "r"((char *)bench_buf + 1)
+		     : "memory");
+}
+
+/*
+ * Core primitives of the firmware library, which use Zbb instructions
+ * when PLATFORM_RISCV_ISA has Zbb. Comparing a default and a Zbb build
+ * shows the gain on the target.
+ */
+static char bench_str_a[BENCH_STR_LEN + 8] __aligned(8);
+static char bench_str_b[BENCH_STR_LEN + 8] __aligned(8);
+static unsigned long bench_mask_sparse[BENCH_MASK_BITS / __riscv_xlen];
+static unsigned long bench_mask_dense[BENCH_MASK_BITS / __riscv_xlen];
+
+static void bench_init_primitives(void)
+{
+	unsigned long i;
+
+	for (i = 0; i < BENCH_STR_LEN; i++)
+		bench_str_a[i] = bench_str_b[i] = 'a' + i % 26;
+
+	/* Every 32nd HART of the sparse mask and all of the dense mask */
+	for (i = 0; i < BENCH_MASK_BITS; i++) {
+		if (!(i % 32))
+			bench_mask_sparse[i / __riscv_xlen] |=
+						1UL << (i % __riscv_xlen);
+		bench_mask_dense[i / __riscv_xlen] |= 1UL << (i % __riscv_xlen);
+	}
+}
+
+static void bench_strlen(const void *arg)
+{
+	sbi_strlen(arg);
+}
+
+static void bench_strncmp(const void *arg)
+{
+	sbi_strncmp(bench_str_a, bench_str_b, BENCH_STR_LEN + 1);
+}
+
+static void bench_mask_walk(const void *arg)
+{
+	unsigned long bit, sum = 0;
+
+	for_each_set_bit(bit, (const unsigned long *)arg, BENCH_MASK_BITS)
+		sum += bit;
+	asm volatile("" : : "r"(sum));
+}
+
+static void bench_fdt_walk(const void *fdt)
+{
+	int noff, len, sum = 0;
+
+	for (noff = fdt_next_node(fdt, -1, NULL); noff >= 0;
+	     noff = fdt_next_node(fdt, noff, NULL)) {
+		if (fdt_getprop(fdt, noff, "compatible", &len))
+			sum += len;
+	}
+	asm volatile("" : : "r"(sum));
+}
+
+static void bench_run_primitives(const void *fdt)
+{
+	bench_init_primitives();
+	bench_run("strlen 256 bytes", bench_strlen, bench_str_a);
+	bench_run("strlen 253 bytes, unaligned", bench_strlen,
+		  bench_str_a + 3);
+	bench_run("strncmp 256 bytes, equal", bench_strncmp, 0);
+	bench_run("hartmask walk, 8 of 256 set", bench_mask_walk,
+		  bench_mask_sparse);
+	bench_run("hartmask walk, 256 of 256 set", bench_mask_walk,
+		  bench_mask_dense);
+	if (fdt && !fdt_check_header(fdt))
+		bench_run("fdt walk, boot device tree", bench_fdt_walk, fdt);
+	else
+		bench_puts("fdt walk: skipped (no device tree)\n");
+}
+
+struct bench_rfence {
+	unsigned long hmask;
+	unsigned long hbase;
+	unsigned long size;
+};
+
+static void bench_rfence(const void *arg)
+{
+	const struct bench_rfence *rf = arg;
+
+	sbi_ecall_4(SBI_EXT_RFENCE, SBI_EXT_RFENCE_REMOTE_SFENCE_VMA,
+		    rf->hmask, rf->hbase, 0, rf->size);
+}
+
+static void bench_ipi_roundtrip(const void *arg)
+{
+	unsigned long hartid = *(const unsigned long *)arg;
+
+	sbi_ecall_2(SBI_EXT_IPI, SBI_EXT_IPI_SEND_IPI, 1, hartid);
+	while (!(csr_read(CSR_SIP) & SIP_SSIP))
+		;
+	csr_clear(CSR_SIP, SIP_SSIP);
+}
+
+static const struct {
+	const char *name;
+	unsigned long size;
+} bench_rfence_sizes[] = {
+	{ "4K", 0x1000 },
+	{ "64K", 0x10000 },
+	{ "1M", 0x100000 },
+	{ "all", -1UL },
+};
+
+static void bench_run_rfence(unsigned long i, unsigned long remote)
+{
+	char name[BENCH_NAME_WIDTH + 1];
+	struct bench_rfence rf;
+	unsigned long h;
+	int pos;
+
+	rf.size = bench_rfence_sizes[i].size;
+	pos = bench_fmt_str(name, 0, "rfence.vma ", 0);
+	pos = bench_fmt_str(name, pos, bench_rfence_sizes[i].name, 0);
+	if (remote) {
+		/* The first remote secondary HARTs */
+		rf.hmask = 0;
+		rf.hbase = 0;
+		for (h = 1; h <= remote; h++)
+			rf.hmask |= 1UL << bench_hartids[h];
+		pos = bench_fmt_str(name, pos, " remote x", 0);
+		bench_fmt_num(name, pos, remote, 0);
+	} else {
+		/* Only the calling HART */
+		rf.hmask = 1;
+		rf.hbase = boot_hartid;
+		bench_fmt_str(name, pos, " local", 0);
+	}
+
+	bench_run(name, bench_rfence, &rf);
+}
+
+static void bench_run_rfences(void)
+{
+	unsigned long i, n, secondaries = bench_hart_count - 1;
+
+	for (i = 0; i < array_size(bench_rfence_sizes); i++) {
+		bench_run_rfence(i, 0);
+		for (n = 1; n < secondaries; n *= 2)
+			bench_run_rfence(i, n);
+		if (secondaries)
+			bench_run_rfence(i, secondaries);
+	}
+}
+
+/* Event idx of the firmware event counted by every SET_TIMER call */
+#define BENCH_PMU_EVENT_SET_TIMER	\
+	((SBI_PMU_EVENT_TYPE_FW << 16) | SBI_PMU_FW_SET_TIMER)
+
+static u64 bench_pmu_snapshot[SBI_PMU_SNAPSHOT_SIZE / sizeof(u64)]
+					__aligned(SBI_PMU_SNAPSHOT_SIZE);
+
+/* Match a firmware counter for SET_TIMER calls, returns -1 if none */
+static long bench_pmu_match_fw(void)
+{
+	unsigned long cidx, num;
+	struct sbiret ret;
+
+	ret = sbi_ecall_0(SBI_EXT_PMU, SBI_EXT_PMU_NUM_COUNTERS);
+	if (ret.error)
+		return -1;
+	num = ret.value;
+
+	for (cidx = 0; cidx < num; cidx++) {
+		ret = sbi_ecall(SBI_EXT_PMU, SBI_EXT_PMU_COUNTER_GET_INFO,
+				cidx, 0, 0, 0, 0);
+		/* The type bit is the MSB of the counter info */
+		if (ret.error || (long)ret.value >= 0)
+			continue;
+		ret = sbi_ecall(SBI_EXT_PMU, SBI_EXT_PMU_COUNTER_CFG_MATCH,
+				cidx, 1, 0, BENCH_PMU_EVENT_SET_TIMER, 0);
+		if (!ret.error)
+			return ret.value;
+	}
+
+	return -1;
+}
+
+/*
+ * Wrap the SET_TIMER firmware counter and check where the overflow is
+ * reported. Without snapshot shared memory S-mode has no way to find the
+ * overflowed counter so LCOFIP must not be raised. With it, the overflow
+ * bitmap must have the bit of the counter and LCOFIP is raised if the
+ * HART has Sscofpmf.
+ */
+static void bench_check_pmu_fw_overflow(bool snapshot)
+{
+	unsigned long stop_flags = SBI_PMU_STOP_FLAG_RESET;
+	const char *result = "FAIL";
+	bool lcofip = FALSE, wrapped = FALSE;
+	struct sbiret ret;
+	char line[96];
+	long cidx;
+	int pos;
+
+	csr_clear(CSR_SIP, MIP_LCOFIP);
+	cidx = bench_pmu_match_fw();
+	if (cidx < 0) {
+		result = "skipped (no firmware counter)";
+		goto report;
+	}
+
+	if (snapshot) {
+		ret = sbi_ecall_3(SBI_EXT_PMU, SBI_EXT_PMU_SNAPSHOT_SET_SHMEM,
+				  (unsigned long)bench_pmu_snapshot, 0, 0);
+		if (ret.error) {
+			result = "skipped (no snapshot support)";
+			goto stop;
+		}
+		stop_flags |= SBI_PMU_STOP_FLAG_TAKE_SNAPSHOT;
+	}
+
+	/* Start one increment before the firmware counter wraps */
+	ret = sbi_ecall(SBI_EXT_PMU, SBI_EXT_PMU_COUNTER_START, cidx, 1,
+			SBI_PMU_START_FLAG_SET_INIT_VALUE, -1UL, -1UL);
+	if (ret.error)
+		goto stop;
+	bench_set_timer(0);
+	lcofip = (csr_read(CSR_SIP) & MIP_LCOFIP) ? TRUE : FALSE;
+
+	ret = sbi_ecall_2(SBI_EXT_PMU, SBI_EXT_PMU_COUNTER_FW_READ, cidx, 0);
+	wrapped = (!ret.error && !ret.value) ? TRUE : FALSE;
+	if (wrapped && !snapshot)
+		result = lcofip ? "FAIL (LCOFIP raised)" : "ok";
+
+stop:
+	ret = sbi_ecall_3(SBI_EXT_PMU, SBI_EXT_PMU_COUNTER_STOP, cidx, 1,
+			  stop_flags);
+	/* Bit 0 of the overflow bitmap is the counter at the base */
+	if (wrapped && snapshot && !ret.error && (bench_pmu_snapshot[0] & 1))
+		result = lcofip ? "ok (LCOFIP raised)" : "ok (no LCOFIP)";
+	if (snapshot)
+		sbi_ecall_2(SBI_EXT_PMU, SBI_EXT_PMU_SNAPSHOT_SET_SHMEM,
+			    -1UL, -1UL);
+	csr_clear(CSR_SIP, MIP_LCOFIP);
+
+report:
+	pos = bench_fmt_str(line, 0, snapshot ? "pmu fw overflow, snapshot" :
+				     "pmu fw overflow, no snapshot",
+			    BENCH_NAME_WIDTH);
+	pos = bench_fmt_str(line, pos, result, 0);
+	bench_fmt_str(line, pos, "\n", 0);
+	bench_puts(line);
+}
+
+void bench_main(unsigned long a0, unsigned long a1)
+{
+	char line[96];
+	int pos;
+
+	boot_hartid = a0;
+	bench_start_secondaries();
+
+	bench_puts("\nSBI benchmark payload running\n");
+	pos = bench_fmt_str(line, 0, "Boot HART ", 0);
+	pos = bench_fmt_num(line, pos, boot_hartid, 0);
+	pos = bench_fmt_str(line, pos, ", HARTs ", 0);
+	pos = bench_fmt_num(line, pos, bench_hart_count, 0);
+	pos = bench_fmt_str(line, pos, ", samples ", 0);
+	pos = bench_fmt_num(line, pos, BENCH_SAMPLES, 0);
+	bench_fmt_str(line, pos, " (cycles)\n\n", 0);
+	bench_puts(line);
+
+	pos = bench_fmt_str(line, 0, "operation", BENCH_NAME_WIDTH);
+	pos = bench_fmt_str(line, pos, "       min", 0);
+	pos = bench_fmt_str(line, pos, "    median", 0);
+	bench_fmt_str(line, pos, "       p99\n", 0);
+	bench_puts(line);
+
+	bench_run("empty (measurement overhead)", bench_empty, 0);
+	bench_run("ecall base.get_spec_version", bench_null_ecall, 0);
+	bench_run("time.set_timer", bench_set_timer, 0);
+	bench_run("rdtime", bench_rdtime, 0);
+	bench_run("misaligned load", bench_misaligned_load, 0);
+	bench_run("misaligned store", bench_misaligned_store, 0);
+	bench_run_primitives((const void *)a1);
+	bench_run_rfences();
+	if (bench_hart_count > 1)
+		bench_run("ipi round-trip", bench_ipi_roundtrip,
+			  &bench_hartids[1]);
+	else
+		bench_puts("ipi round-trip: skipped (single HART)\n");
+
+	bench_puts("\n");
+	bench_check_pmu_fw_overflow(FALSE);
+	bench_check_pmu_fw_overflow(TRUE);
+
+	bench_puts("\nSBI benchmark payload done\n");
+
+	while (1)
+		wfi();
+}
@@ -8,6 +8,7 @@
 #
 
 firmware-bins-$(FW_PAYLOAD) += payloads/test.bin
+firmware-bins-$(FW_PAYLOAD) += payloads/bench.bin
 
 test-y += test_head.o
 test-y += test_main.o
@@ -17,3 +18,12 @@ test-y += test_main.o
 
 %/test.dep: $(foreach dep,$(test-y:.o=.dep),%/$(dep))
 	$(call merge_deps,$@,$^)
+
+bench-y += bench_head.o
+bench-y += bench_main.o
+
+%/bench.o: $(foreach obj,$(bench-y),%/$(obj))
+	$(call merge_objs,$@,$^)
+
+%/bench.dep: $(foreach dep,$(bench-y:.o=.dep),%/$(dep))
+	$(call merge_deps,$@,$^)
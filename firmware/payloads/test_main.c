@@ -31,6 +31,16 @@
 
 static inline void sbi_ecall_console_puts(const char *str)
 {
+	unsigned long len = 0;
+
+	while (str && str[len])
+		len++;
+
+	/* Write the whole string at once with DBCN if available */
+	if (len && !SBI_ECALL(SBI_EXT_DBCN, SBI_EXT_DBCN_CONSOLE_WRITE,
+			      len, str, 0))
+		return;
+
 	while (str && *str)
 		sbi_ecall_console_putc(*str++);
 }
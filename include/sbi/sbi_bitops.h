@@ -46,6 +46,9 @@
  */
 static inline int ffs(int x)
 {
+#ifdef __riscv_zbb
+	return __builtin_ffs(x);
+#else
 	int r = 1;
 
 	if (!x)
@@ -69,6 +72,7 @@ static inline int ffs(int x)
 	if (!(x & 1))
 		r += 1;
 	return r;
+#endif
 }
 
 /**
@@ -79,6 +83,9 @@ static inline int ffs(int x)
  */
 static inline int __ffs(unsigned long word)
 {
+#ifdef __riscv_zbb
+	return __builtin_ctzl(word);
+#else
 	int num = 0;
 
 #if BITS_PER_LONG == 64
@@ -106,6 +113,7 @@ static inline int __ffs(unsigned long word)
 	if ((word & 0x1) == 0)
 		num += 1;
 	return num;
+#endif
 }
 
 /*
@@ -126,6 +134,9 @@ static inline int __ffs(unsigned long word)
 
 static inline int fls(int x)
 {
+#ifdef __riscv_zbb
+	return x ? 32 - __builtin_clz(x) : 0;
+#else
 	int r = 32;
 
 	if (!x)
@@ -149,6 +160,7 @@ static inline int fls(int x)
 	if (!(x & 0x80000000u))
 		r -= 1;
 	return r;
+#endif
 }
 
 /**
@@ -159,6 +171,9 @@ static inline int fls(int x)
  */
 static inline unsigned long __fls(unsigned long word)
 {
+#ifdef __riscv_zbb
+	return BITS_PER_LONG - 1 - __builtin_clzl(word);
+#else
 	int num = BITS_PER_LONG - 1;
 
 #if BITS_PER_LONG == 64
@@ -186,6 +201,7 @@ static inline unsigned long __fls(unsigned long word)
 	if (!(word & (~0ul << (BITS_PER_LONG-1))))
 		num -= 1;
 	return num;
+#endif
 }
 
 #define for_each_set_bit(bit, addr, size) \
@@ -0,0 +1,85 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2021 Renesas Electronics Corporation
+ */
+
+#ifndef __SBI_BOOT_TRACE_H__
+#define __SBI_BOOT_TRACE_H__
+
+#include <sbi/sbi_types.h>
+
+/**
+ * Boot phase boundaries recorded by the cold boot sequence
+ *
+ * Other HARTs only run their warm boot once S-mode starts them, which
+ * is after the device tree was handed over, so they are not traced.
+ */
+enum sbi_boot_trace_phase {
+	/** Entry into sbi_init() */
+	SBI_BOOT_TRACE_ENTRY = 0,
+	/** End of scratch, domain and HSM init */
+	SBI_BOOT_TRACE_HSM,
+	/** End of platform early init */
+	SBI_BOOT_TRACE_EARLY,
+	/** End of HART init */
+	SBI_BOOT_TRACE_HART,
+	/** End of console init */
+	SBI_BOOT_TRACE_CONSOLE,
+	/** End of PMU init */
+	SBI_BOOT_TRACE_PMU,
+	/** End of platform irqchip init */
+	SBI_BOOT_TRACE_IRQCHIP,
+	/** End of IPI init */
+	SBI_BOOT_TRACE_IPI,
+	/** End of TLB init */
+	SBI_BOOT_TRACE_TLB,
+	/** End of timer init */
+	SBI_BOOT_TRACE_TIMER,
+	/** End of ecall init */
+	SBI_BOOT_TRACE_ECALL,
+	/** End of domain finalize */
+	SBI_BOOT_TRACE_DOMAIN,
+	/** End of PMP configuration */
+	SBI_BOOT_TRACE_PMP,
+	/** End of platform final init (including FDT fixups) */
+	SBI_BOOT_TRACE_FINAL,
+	/** Ready to jump to next booting stage */
+	SBI_BOOT_TRACE_DONE,
+	/** Maximum number of boot phase boundaries */
+	SBI_BOOT_TRACE_PHASE_MAX
+};
+
+struct sbi_scratch;
+
+/** Read the timestamp counter used for boot tracing (MCYCLE) */
+u64 sbi_boot_trace_timestamp(void);
+
+/** Name of a boot phase boundary */
+const char *sbi_boot_trace_phase_name(u32 phase);
+
+/** Record a boot phase boundary with given timestamp */
+void sbi_boot_trace_record_at(struct sbi_scratch *scratch, u32 phase,
+			      u64 timestamp);
+
+/** Record a boot phase boundary for the boot HART */
+static inline void sbi_boot_trace_record(struct sbi_scratch *scratch,
+					 u32 phase)
+{
+	sbi_boot_trace_record_at(scratch, phase, sbi_boot_trace_timestamp());
+}
+
+/**
+ * Get timestamp of a boot phase boundary
+ *
+ * @return timestamp or zero if the boundary was not recorded
+ */
+u64 sbi_boot_trace_get(struct sbi_scratch *scratch, u32 phase);
+
+/** Print boot phase timestamps of given HART as a table */
+void sbi_boot_trace_dump(struct sbi_scratch *scratch, u32 hartid);
+
+/** Initialize boot tracing on the boot HART */
+int sbi_boot_trace_init(struct sbi_scratch *scratch);
+
+#endif
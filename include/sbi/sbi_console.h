@@ -19,6 +19,12 @@ struct sbi_console_device {
 	/** Write a character to the console output */
 	void (*console_putc)(char ch);
 
+	/**
+	 * Write a string to the console output (optional). Returns the
+	 * number of characters written which must be non-zero for len > 0.
+	 */
+	unsigned long (*console_puts)(const char *str, unsigned long len);
+
 	/** Read a character from the console input */
 	int (*console_getc)(void);
 };
@@ -33,8 +39,13 @@ void sbi_putc(char ch);
 
 void sbi_puts(const char *str);
 
+/* Write up to len bytes and return the number of bytes written */
+unsigned long sbi_nputs(const char *str, unsigned long len);
+
 void sbi_gets(char *s, int maxwidth, char endchar);
 
+unsigned long sbi_ngets(char *str, unsigned long len);
+
 int __printf(2, 3) sbi_sprintf(char *out, const char *format, ...);
 
 int __printf(3, 4) sbi_snprintf(char *out, u32 out_sz, const char *format, ...);
@@ -83,6 +83,16 @@ struct sbi_domain_memregion {
 	unsigned long flags;
 };
 
+/** Address interval of a domain with resolved memory region precedence */
+struct sbi_domain_interval {
+	/** Start address (interval ends before start of next interval) */
+	unsigned long start;
+	/** Flags of the memory region covering this interval */
+	unsigned long flags;
+	/** Is this interval covered by any memory region */
+	bool covered;
+};
+
 /** Maximum number of domains */
 #define SBI_DOMAIN_MAX_INDEX			32
 
@@ -99,12 +109,33 @@ struct sbi_domain {
 	 * in the coldboot path
 	 */
 	struct sbi_hartmask assigned_harts;
+	/**
+	 * Assigned HARTs which are STARTED or SUSPENDED
+	 * Note: This is updated atomically by HSM state changes, which
+	 * only happen after domains are registered in the coldboot path
+	 */
+	struct sbi_hartmask interruptible_harts;
 	/** Name of this domain */
 	char name[64];
 	/** Possible HARTs in this domain */
 	const struct sbi_hartmask *possible_harts;
 	/** Array of memory regions terminated by a region with order zero */
 	struct sbi_domain_memregion *regions;
+	/**
+	 * Sorted non-overlapping address intervals covering the whole
+	 * address space which are used for faster address checks
+	 * Note: This set by sbi_domain_finalize() in the coldboot path
+	 */
+	const struct sbi_domain_interval *intervals;
+	/** Number of entries in the address interval table */
+	u32 interval_count;
+	/**
+	 * Precomputed pmpcfg CSR values followed by pmpaddr CSR values
+	 * Note: This set by sbi_domain_finalize() in the coldboot path
+	 */
+	const unsigned long *pmp_image;
+	/** Number of PMP entries in the precomputed PMP image */
+	u32 pmp_image_count;
 	/** HART id of the HART booting this domain */
 	u32 boot_hartid;
 	/** Arg1 (or 'a1' register) of next booting stage for this domain */
@@ -191,6 +222,21 @@ bool sbi_domain_check_addr(const struct sbi_domain *dom,
 			   unsigned long addr, unsigned long mode,
 			   unsigned long access_flags);
 
+/**
+ * Check whether we can access specified address range for given mode and
+ * memory region flags under a domain
+ * @param dom pointer to domain
+ * @param addr the start of the address range to be checked
+ * @param size the size of the address range to be checked
+ * @param mode the privilege mode of access
+ * @param access_flags bitmask of domain access types (enum sbi_domain_access)
+ * @return TRUE if access allowed otherwise FALSE
+ */
+bool sbi_domain_check_addr_range(const struct sbi_domain *dom,
+				 unsigned long addr, unsigned long size,
+				 unsigned long mode,
+				 unsigned long access_flags);
+
 /** Dump domain details on the console */
 void sbi_domain_dump(const struct sbi_domain *dom, const char *suffix);
 
@@ -38,8 +38,11 @@ extern struct sbi_ecall_extension ecall_rfence;
 extern struct sbi_ecall_extension ecall_ipi;
 extern struct sbi_ecall_extension ecall_vendor;
 extern struct sbi_ecall_extension ecall_hsm;
+extern struct sbi_ecall_extension ecall_opensbi_hsm;
 extern struct sbi_ecall_extension ecall_srst;
 extern struct sbi_ecall_extension ecall_pmu;
+extern struct sbi_ecall_extension ecall_opensbi_pmu;
+extern struct sbi_ecall_extension ecall_dbcn;
 
 u16 sbi_ecall_version_major(void);
 
@@ -29,6 +29,7 @@
 #define SBI_EXT_HSM				0x48534D
 #define SBI_EXT_SRST				0x53525354
 #define SBI_EXT_PMU				0x504D55
+#define SBI_EXT_DBCN				0x4442434E
 
 /* SBI function IDs for BASE extension*/
 #define SBI_EXT_BASE_GET_SPEC_VERSION		0x0
@@ -99,6 +100,7 @@
 #define SBI_EXT_PMU_COUNTER_START	0x3
 #define SBI_EXT_PMU_COUNTER_STOP	0x4
 #define SBI_EXT_PMU_COUNTER_FW_READ	0x5
+#define SBI_EXT_PMU_SNAPSHOT_SET_SHMEM	0x7
 
 /** General pmu event codes specified in SBI PMU extension */
 enum sbi_pmu_hw_generic_events_t {
@@ -220,9 +222,22 @@ enum sbi_pmu_ctr_type {
 
 /* Flags defined for counter start function */
 #define SBI_PMU_START_FLAG_SET_INIT_VALUE (1 << 0)
+#define SBI_PMU_START_FLAG_INIT_SNAPSHOT (1 << 1)
 
 /* Flags defined for counter stop function */
 #define SBI_PMU_STOP_FLAG_RESET (1 << 0)
+#define SBI_PMU_STOP_FLAG_TAKE_SNAPSHOT (1 << 1)
+
+/* Size and layout of PMU snapshot shared memory */
+#define SBI_PMU_SNAPSHOT_SIZE			0x1000
+#define SBI_PMU_SNAPSHOT_OVERFLOW_OFFSET	0x0
+#define SBI_PMU_SNAPSHOT_VALUES_OFFSET		0x8
+#define SBI_PMU_SNAPSHOT_VALUES_MAX		64
+
+/* SBI function IDs for DBCN extension */
+#define SBI_EXT_DBCN_CONSOLE_WRITE		0x0
+#define SBI_EXT_DBCN_CONSOLE_READ		0x1
+#define SBI_EXT_DBCN_CONSOLE_WRITE_BYTE		0x2
 
 /* SBI base specification related macros */
 #define SBI_SPEC_VERSION_MAJOR_OFFSET		24
@@ -233,6 +248,20 @@ enum sbi_pmu_ctr_type {
 #define SBI_EXT_FIRMWARE_START			0x0A000000
 #define SBI_EXT_FIRMWARE_END			0x0AFFFFFF
 
+/* OpenSBI specific extension IDs in the firmware extension space */
+#define SBI_EXT_OPENSBI_HSM			(SBI_EXT_FIRMWARE_START + 0x0)
+
+#define SBI_EXT_OPENSBI_PMU			(SBI_EXT_FIRMWARE_START + 0x1)
+
+/* SBI function IDs for OpenSBI HSM extension */
+#define SBI_EXT_OPENSBI_HSM_HART_START_MANY	0x0
+
+/* SBI function IDs for OpenSBI PMU extension */
+#define SBI_EXT_OPENSBI_PMU_MUX_TIME_ENABLED	0x0
+#define SBI_EXT_OPENSBI_PMU_MUX_TIME_RUNNING	0x1
+#define SBI_EXT_OPENSBI_PMU_MUX_TIME_ENABLED_HI	0x2
+#define SBI_EXT_OPENSBI_PMU_MUX_TIME_RUNNING_HI	0x3
+
 /* SBI return error codes */
 #define SBI_SUCCESS				0
 #define SBI_ERR_FAILED				-1
@@ -243,8 +272,9 @@ enum sbi_pmu_ctr_type {
 #define SBI_ERR_ALREADY_AVAILABLE		-6
 #define SBI_ERR_ALREADY_STARTED			-7
 #define SBI_ERR_ALREADY_STOPPED			-8
+#define SBI_ERR_NO_SHMEM			-9
 
-#define SBI_LAST_ERR				SBI_ERR_ALREADY_STOPPED
+#define SBI_LAST_ERR				SBI_ERR_NO_SHMEM
 
 /* clang-format on */
 
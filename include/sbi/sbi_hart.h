@@ -29,10 +29,14 @@ enum sbi_hart_features {
 	SBI_HART_HAS_LAST_FEATURE = SBI_HART_HAS_TIME,
 };
 
+struct sbi_domain;
 struct sbi_scratch;
 
 int sbi_hart_reinit(struct sbi_scratch *scratch);
 int sbi_hart_init(struct sbi_scratch *scratch, bool cold_boot);
+void sbi_hart_context_save(struct sbi_scratch *scratch);
+void sbi_hart_context_discard(struct sbi_scratch *scratch);
+int sbi_hart_context_restore(struct sbi_scratch *scratch);
 
 extern void (*sbi_hart_expected_trap)(void);
 static inline ulong sbi_hart_expected_trap_addr(void)
@@ -47,6 +51,8 @@ unsigned int sbi_hart_pmp_count(struct sbi_scratch *scratch);
 unsigned long sbi_hart_pmp_granularity(struct sbi_scratch *scratch);
 unsigned int sbi_hart_pmp_addrbits(struct sbi_scratch *scratch);
 unsigned int sbi_hart_mhpm_bits(struct sbi_scratch *scratch);
+int sbi_hart_pmp_image_build(struct sbi_scratch *scratch,
+			     struct sbi_domain *dom);
 int sbi_hart_pmp_configure(struct sbi_scratch *scratch);
 bool sbi_hart_has_feature(struct sbi_scratch *scratch, unsigned long feature);
 void sbi_hart_get_features_str(struct sbi_scratch *scratch,
@@ -134,6 +134,30 @@ static inline void sbi_hartmask_xor(struct sbi_hartmask *dstp,
 		   sbi_hartmask_bits(src2p), SBI_HARTMASK_MAX_BITS);
 }
 
+/**
+ * Get BITS_PER_LONG HARTs of a hartmask starting from a HART id
+ * @param m the hartmask pointer
+ * @param hbase the HART id of bit 0 in the returned word
+ */
+static inline ulong sbi_hartmask_word(const struct sbi_hartmask *m,
+				      ulong hbase)
+{
+	ulong ret, bword, boff;
+
+	bword = BIT_WORD(hbase);
+	boff = BIT_WORD_OFFSET(hbase);
+	if (BIT_WORD(SBI_HARTMASK_MAX_BITS) <= bword)
+		return 0;
+
+	ret = sbi_hartmask_bits(m)[bword++] >> boff;
+	if (boff && bword < BIT_WORD(SBI_HARTMASK_MAX_BITS)) {
+		ret |= (sbi_hartmask_bits(m)[bword] &
+			(BIT(boff) - 1UL)) << (BITS_PER_LONG - boff);
+	}
+
+	return ret;
+}
+
 /** Iterate over each HART in hartmask */
 #define sbi_hartmask_for_each_hart(__h, __m)	\
 	for_each_set_bit(__h, (__m)->bits, SBI_HARTMASK_MAX_BITS)
@@ -37,6 +37,15 @@ struct sbi_hsm_device {
 	 * specified resume address
 	 */
 	int (*hart_suspend)(u32 suspend_type, ulong raddr);
+
+	/**
+	 * Check whether per-hart state not covered by the firmware
+	 * snapshot (such as interrupt controller contexts) was lost
+	 * while the current hart was in given non-retentive suspend
+	 * state. If not provided then the snapshot taken at suspend
+	 * time is considered sufficient to resume the hart.
+	 */
+	bool (*hart_state_lost)(u32 suspend_type);
 };
 
 struct sbi_domain;
@@ -52,8 +61,13 @@ void __noreturn sbi_hsm_exit(struct sbi_scratch *scratch);
 int sbi_hsm_hart_start(struct sbi_scratch *scratch,
 		       const struct sbi_domain *dom,
 		       u32 hartid, ulong saddr, ulong smode, ulong priv);
+int sbi_hsm_hart_start_many(struct sbi_scratch *scratch,
+			    const struct sbi_domain *dom,
+			    ulong hmask, ulong hbase, ulong saddr,
+			    ulong smode, ulong priv);
 int sbi_hsm_hart_stop(struct sbi_scratch *scratch, bool exitnow);
 void sbi_hsm_hart_resume_start(struct sbi_scratch *scratch);
+bool sbi_hsm_hart_resume_state_lost(struct sbi_scratch *scratch);
 void sbi_hsm_hart_resume_finish(struct sbi_scratch *scratch);
 int sbi_hsm_hart_suspend(struct sbi_scratch *scratch, u32 suspend_type,
 			 ulong raddr, ulong rmode, ulong priv);
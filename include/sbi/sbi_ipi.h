@@ -28,6 +28,15 @@ struct sbi_ipi_device {
 
 	/** Clear IPI for a target HART */
 	void (*ipi_clear)(u32 target_hart);
+
+	/**
+	 * Send IPI to multiple target HARTs at once
+	 * Note: This is an optional callback and ipi_send() is used for
+	 * each target HART when not provided. Devices with a register
+	 * per HART (such as ACLINT MSWI) can still save the ordering
+	 * fence of each ipi_send() call.
+	 */
+	void (*ipi_send_many)(ulong hmask, ulong hbase);
 };
 
 struct sbi_scratch;
@@ -73,10 +82,12 @@ void sbi_ipi_clear_smode(void);
 
 int sbi_ipi_send_halt(ulong hmask, ulong hbase);
 
-void sbi_ipi_process(void);
+void sbi_ipi_process(struct sbi_scratch *scratch);
 
 void sbi_ipi_raw_send(u32 target_hart);
 
+void sbi_ipi_raw_send_many(ulong hmask, ulong hbase);
+
 const struct sbi_ipi_device *sbi_ipi_get_device(void);
 
 void sbi_ipi_set_device(const struct sbi_ipi_device *dev);
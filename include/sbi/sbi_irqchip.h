@@ -0,0 +1,35 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2021 Renesas Electronics Corporation
+ */
+
+#ifndef __SBI_IRQCHIP_H__
+#define __SBI_IRQCHIP_H__
+
+#include <sbi/sbi_types.h>
+
+struct sbi_scratch;
+struct sbi_trap_regs;
+
+/**
+ * Set the function which processes M-mode external interrupts
+ *
+ * The function is called from the trap path for each M-mode external
+ * interrupt. It is expected to claim, dispatch and complete all pending
+ * interrupt sources and to return zero on success.
+ *
+ * @param fn function processing M-mode external interrupts
+ */
+void sbi_irqchip_set_irqfn(int (*fn)(struct sbi_trap_regs *regs));
+
+/** Process an M-mode external interrupt */
+int sbi_irqchip_process(struct sbi_trap_regs *regs);
+
+/** Initialize interrupt controller for current HART */
+int sbi_irqchip_init(struct sbi_scratch *scratch, bool cold_boot);
+
+/** Exit interrupt controller for current HART */
+void sbi_irqchip_exit(struct sbi_scratch *scratch);
+
+#endif
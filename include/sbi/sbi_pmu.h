@@ -19,13 +19,27 @@
 /* Maximum number of hardware events that can mapped by OpenSBI */
 #define SBI_PMU_HW_EVENT_MAX 64
 
+/* Maximum number of hardware event select values that can be saved */
+#define SBI_PMU_HW_EVENT_SELECT_MAX (SBI_PMU_HW_EVENT_MAX * 2)
+
 /* Maximum number of firmware events that can mapped by OpenSBI */
 #define SBI_PMU_FW_EVENT_MAX 32
 
 /* Counter related macros */
 #define SBI_PMU_FW_CTR_MAX 16
 #define SBI_PMU_HW_CTR_MAX 32
-#define SBI_PMU_CTR_MAX	   (SBI_PMU_HW_CTR_MAX + SBI_PMU_FW_CTR_MAX)
+/* Logical counters multiplexed onto free hardware counters */
+#ifndef SBI_PMU_MUX_CTR_MAX
+#define SBI_PMU_MUX_CTR_MAX 8
+#endif
+#define SBI_PMU_CTR_MAX	   (SBI_PMU_HW_CTR_MAX + SBI_PMU_FW_CTR_MAX + \
+			    SBI_PMU_MUX_CTR_MAX)
+
+/* Minimum time slice of a multiplexed counter in milliseconds */
+#ifndef SBI_PMU_MUX_INTERVAL_MS
+#define SBI_PMU_MUX_INTERVAL_MS 4
+#endif
+
 #define SBI_PMU_FIXED_CTR_MASK 0x07
 
 /** Initialize PMU */
@@ -53,6 +67,22 @@ int sbi_pmu_add_hw_event_counter_map(u32 eidx_start, u32 eidx_end, u32 cmap);
 
 int sbi_pmu_add_raw_event_counter_map(uint64_t select, uint64_t select_mask, u32 cmap);
 
+/**
+ * Add the mhpmevent select value of a hardware event. This should be called
+ * from the platform code to populate the event select table.
+ * @param eidx   Event idx of the hardware event
+ * @param select mhpmevent select value of the event
+ * @return 0 on success, error otherwise.
+ */
+int sbi_pmu_add_event_select(u32 eidx, uint64_t select);
+
+/**
+ * Get the mhpmevent select value of a hardware event
+ * @param eidx Event idx of the hardware event
+ * @return The select value added for the event or 0 if not found
+ */
+uint64_t sbi_pmu_get_event_select(u32 eidx);
+
 int sbi_pmu_ctr_read(uint32_t cidx, unsigned long *cval);
 
 int sbi_pmu_ctr_stop(unsigned long cidx_base, unsigned long cidx_mask,
@@ -63,12 +93,47 @@ int sbi_pmu_ctr_start(unsigned long cidx_base, unsigned long cidx_mask,
 
 int sbi_pmu_ctr_get_info(uint32_t cidx, unsigned long *ctr_info);
 
+/**
+ * Set or clear the counter snapshot shared memory of the current HART
+ * @param shmem_lo lower XLEN bits of the physical address
+ * @param shmem_hi upper XLEN bits of the physical address
+ * @param flags must be zero
+ * @param smode privilege mode of the caller
+ * @return 0 on success, error otherwise.
+ */
+int sbi_pmu_snapshot_set_shmem(unsigned long shmem_lo, unsigned long shmem_hi,
+				unsigned long flags, unsigned long smode);
+
 unsigned long sbi_pmu_num_ctr(void);
 
 int sbi_pmu_ctr_cfg_match(unsigned long cidx_base, unsigned long cidx_mask,
 			  unsigned long flags, unsigned long event_idx,
 			  uint64_t event_data);
 
-int sbi_pmu_ctr_incr_fw(enum sbi_pmu_fw_event_code_id fw_id);
+int sbi_pmu_ctr_incr_fw(struct sbi_scratch *scratch,
+			enum sbi_pmu_fw_event_code_id fw_id);
+
+/**
+ * Get the time (in timer ticks) a multiplexed counter was started or
+ * was counting on a hardware counter since it was matched or cleared.
+ * S-mode can scale the count of the counter by their ratio.
+ *
+ * @param cidx counter index of the multiplexed counter
+ * @param running TRUE for the running time and FALSE for the enabled time
+ * @param time the time
+ * @return 0 on success and SBI_EINVAL if cidx is not an active
+ * multiplexed counter
+ */
+int sbi_pmu_mux_ctr_time(uint32_t cidx, bool running, uint64_t *time);
+
+/**
+ * Timer value at which multiplexed counters of current HART must be
+ * rotated or all ones if no started counter is waiting for a hardware
+ * counter.
+ */
+u64 sbi_pmu_mux_deadline(void);
+
+/** Rotate multiplexed counters of current HART if time slice expired */
+void sbi_pmu_mux_tick(void);
 
 #endif
@@ -36,10 +36,16 @@
 #define SBI_SCRATCH_TMP0_OFFSET			(9 * __SIZEOF_POINTER__)
 /** Offset of options member in sbi_scratch */
 #define SBI_SCRATCH_OPTIONS_OFFSET		(10 * __SIZEOF_POINTER__)
+/** Offset of hartid member in sbi_scratch */
+#define SBI_SCRATCH_HARTID_OFFSET		(11 * __SIZEOF_POINTER__)
 /** Offset of extra space in sbi_scratch */
-#define SBI_SCRATCH_EXTRA_SPACE_OFFSET		(11 * __SIZEOF_POINTER__)
+#define SBI_SCRATCH_EXTRA_SPACE_OFFSET		(12 * __SIZEOF_POINTER__)
 /** Maximum size of sbi_scratch (4KB) */
 #define SBI_SCRATCH_SIZE			(0x1000)
+/** Cache line size assumed for sbi_scratch allocations */
+#ifndef SBI_SCRATCH_CACHELINE_SIZE
+#define SBI_SCRATCH_CACHELINE_SIZE		64
+#endif
 
 /* clang-format on */
 
@@ -71,6 +77,11 @@ struct sbi_scratch {
 	unsigned long tmp0;
 	/** Options for OpenSBI library */
 	unsigned long options;
+	/**
+	 * HART id owning this sbi_scratch, which saves reading mhartid
+	 * on paths that already have the sbi_scratch pointer
+	 */
+	unsigned long hartid;
 };
 
 /** Possible options for OpenSBI library */
@@ -79,6 +90,8 @@ enum sbi_scratch_options {
 	SBI_SCRATCH_NO_BOOT_PRINTS = (1 << 0),
 	/** Enable runtime debug prints */
 	SBI_SCRATCH_DEBUG_PRINTS = (1 << 1),
+	/** Print boot phase timestamps and publish them in the FDT */
+	SBI_SCRATCH_BOOT_TRACE = (1 << 2),
 };
 
 /** Get pointer to sbi_scratch for current HART */
@@ -100,6 +113,20 @@ int sbi_scratch_init(struct sbi_scratch *scratch);
  */
 unsigned long sbi_scratch_alloc_offset(unsigned long size);
 
+/**
+ * Allocate aligned space from extra space in sbi_scratch
+ *
+ * The size is rounded-up to the alignment so no other allocation
+ * shares the last aligned block. Data written by remote HARTs should
+ * use SBI_SCRATCH_CACHELINE_SIZE alignment so that it does not share
+ * cache lines with data frequently read by the owner HART.
+ *
+ * @return zero on failure and non-zero (>= SBI_SCRATCH_EXTRA_SPACE_OFFSET)
+ * on success
+ */
+unsigned long sbi_scratch_alloc_aligned_offset(unsigned long size,
+					       unsigned long align);
+
 /** Free-up extra space in sbi_scratch */
 void sbi_scratch_free_offset(unsigned long offset);
 
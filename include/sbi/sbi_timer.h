@@ -66,6 +66,9 @@ void sbi_timer_set_delta_upper(ulong delta_upper);
 /** Start timer event for current HART */
 void sbi_timer_event_start(u64 next_event);
 
+/** Reprogram timer event for current HART after a firmware deadline changed */
+void sbi_timer_event_update(void);
+
 /** Process timer event for current HART */
 void sbi_timer_process(void);
 
@@ -0,0 +1,57 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2021 Renesas Electronics Corporation
+ */
+
+#ifndef __CACHE_ANDES_L2C_H__
+#define __CACHE_ANDES_L2C_H__
+
+#include <sbi/sbi_types.h>
+
+/* Control register fields */
+#define ANDES_L2C_CTL_ENABLE_OFFSET	0
+#define ANDES_L2C_CTL_IPFDPT_OFFSET	3
+#define ANDES_L2C_CTL_DPFDPT_OFFSET	5
+#define ANDES_L2C_CTL_TRAMOCTL_OFFSET	8
+#define ANDES_L2C_CTL_TRAMICTL_OFFSET	10
+#define ANDES_L2C_CTL_DRAMOCTL_OFFSET	11
+#define ANDES_L2C_CTL_DRAMICTL_OFFSET	13
+
+#define ANDES_L2C_CTL_ENABLE_MASK	(1U << ANDES_L2C_CTL_ENABLE_OFFSET)
+#define ANDES_L2C_CTL_IPFDPT_MASK	(3U << ANDES_L2C_CTL_IPFDPT_OFFSET)
+#define ANDES_L2C_CTL_DPFDPT_MASK	(3U << ANDES_L2C_CTL_DPFDPT_OFFSET)
+#define ANDES_L2C_CTL_TRAMOCTL_MASK	(3U << ANDES_L2C_CTL_TRAMOCTL_OFFSET)
+#define ANDES_L2C_CTL_TRAMICTL_MASK	(1U << ANDES_L2C_CTL_TRAMICTL_OFFSET)
+#define ANDES_L2C_CTL_DRAMOCTL_MASK	(3U << ANDES_L2C_CTL_DRAMOCTL_OFFSET)
+#define ANDES_L2C_CTL_DRAMICTL_MASK	(1U << ANDES_L2C_CTL_DRAMICTL_OFFSET)
+
+/* Number of performance monitor counters in the L2 controller */
+#define ANDES_L2C_HPM_COUNT		4
+
+struct andes_l2c_data {
+	unsigned long addr;
+	/* Cache size in bytes, or 0 if unknown */
+	unsigned long size;
+	u32 line_size;
+	/* Control register fields to program, besides the enable bit */
+	u32 ctl_val;
+	u32 ctl_mask;
+	bool has_hpm;
+};
+
+int andes_l2c_init(struct andes_l2c_data *l2c);
+
+bool andes_l2c_available(void);
+
+int andes_l2c_set_prefetch(u32 inst_depth, u32 data_depth);
+
+void andes_l2c_wb_range(unsigned long addr, unsigned long size);
+
+void andes_l2c_inval_range(unsigned long addr, unsigned long size);
+
+void andes_l2c_wbinval_range(unsigned long addr, unsigned long size);
+
+int andes_l2c_hpm_read(u32 idx, u64 *out_val);
+
+#endif
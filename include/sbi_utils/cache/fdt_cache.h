@@ -0,0 +1,31 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2021 Renesas Electronics Corporation
+ */
+
+#ifndef __FDT_CACHE_H__
+#define __FDT_CACHE_H__
+
+#include <sbi/sbi_types.h>
+
+struct fdt_cache {
+	const struct fdt_match *match_table;
+	int (*init)(void *fdt, int nodeoff, const struct fdt_match *match);
+};
+
+/**
+ * fdt_cache_driver_init() - initialize cache driver based on the device-tree
+ */
+int fdt_cache_driver_init(void *fdt, struct fdt_cache *drv);
+
+/**
+ * fdt_cache_init() - initialize cache drivers based on the device-tree
+ *
+ * This function shall be invoked in final init on the cold boot HART.
+ * It returns SBI_ENODEV when no cache controller was found so that
+ * platforms can fall back to their built-in defaults.
+ */
+int fdt_cache_init(void);
+
+#endif
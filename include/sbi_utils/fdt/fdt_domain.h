@@ -55,8 +55,10 @@ int fdt_iterate_each_memregion(void *fdt, int domain_offset, void *opaque,
  * their final_init() platform operation.
  *
  * @param fdt device tree blob
+ *
+ * @return 0 on success and negative error code on failure
  */
-void fdt_domain_fixup(void *fdt);
+int fdt_domain_fixup(void *fdt);
 
 /**
  * Populate domains from device tree
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * fdt_edit.h - Batched Flat Device Tree edit session
+ *
+ * Copyright (c) 2021 Renesas Electronics Corporation
+ */
+
+#ifndef __FDT_EDIT_H__
+#define __FDT_EDIT_H__
+
+#include <sbi/sbi_string.h>
+#include <sbi/sbi_types.h>
+
+/**
+ * Start a batched edit session on the device tree
+ *
+ * While a session is active, fdt_edit_setprop(), fdt_edit_nop_property()
+ * and fdt_edit_nop_node() only queue the edit. The node offsets of the
+ * device tree stay valid until fdt_edit_flush() or fdt_edit_commit()
+ * applies all queued edits in one pass over the structure block.
+ *
+ * Any libfdt read-write call on the same device tree must be preceded
+ * by fdt_edit_flush() while a session is active.
+ *
+ * @param fdt device tree blob
+ *
+ * @return 0 on success and negative libfdt error code on failure
+ */
+int fdt_edit_begin(void *fdt);
+
+/** Check whether an edit session is active on the device tree */
+bool fdt_edit_active(void *fdt);
+
+/**
+ * Apply all queued edits and keep the edit session active
+ *
+ * @param fdt device tree blob
+ *
+ * @return 0 on success and negative libfdt error code on failure
+ */
+int fdt_edit_flush(void *fdt);
+
+/**
+ * Apply all queued edits, pack the device tree and end the session
+ *
+ * The session is ended even on failure. Queued edits which could not be
+ * applied are then dropped but the device tree stays valid, so callers
+ * can redo their fixups without a session.
+ *
+ * @param fdt device tree blob
+ *
+ * @return 0 on success and negative libfdt error code on failure
+ */
+int fdt_edit_commit(void *fdt);
+
+/**
+ * Run a device tree fixup pass which queues edits
+ *
+ * A queued edit fails with -FDT_ERR_NOSPACE once the queue is full. In
+ * that case the queued edits are applied and the pass is run again, so
+ * the pass must look up node offsets afresh and skip edits which are
+ * already present in the device tree. Without an active session the
+ * pass is run only once.
+ *
+ * @param fdt device tree blob
+ * @param pass fixup pass returning 0 or negative libfdt error code
+ * @param priv private data passed to the fixup pass
+ *
+ * @return 0 on success and negative libfdt error code on failure
+ */
+int fdt_edit_run(void *fdt, int (*pass)(void *fdt, void *priv), void *priv);
+
+/**
+ * Set a property of a device tree node
+ *
+ * Without an active session this is same as fdt_setprop(). The value
+ * is copied but the property name must stay valid until the queued
+ * edit is applied. Returns -FDT_ERR_NOSPACE without queueing anything
+ * when the queue is full, see fdt_edit_run().
+ */
+int fdt_edit_setprop(void *fdt, int nodeoff, const char *name,
+		     const void *val, int len);
+
+static inline int fdt_edit_setprop_string(void *fdt, int nodeoff,
+					  const char *name, const char *str)
+{
+	return fdt_edit_setprop(fdt, nodeoff, name, str, sbi_strlen(str) + 1);
+}
+
+/**
+ * Set the "status" property of a device tree node to "disabled"
+ *
+ * Nothing is queued if the node is already disabled so that the call
+ * can be used from a pass run by fdt_edit_run().
+ */
+int fdt_edit_disable_node(void *fdt, int nodeoff);
+
+/**
+ * Remove a property of a device tree node
+ *
+ * Without an active session this is same as fdt_nop_property().
+ */
+int fdt_edit_nop_property(void *fdt, int nodeoff, const char *name);
+
+/**
+ * Remove a device tree node along with all its subnodes
+ *
+ * Without an active session this is same as fdt_nop_node().
+ */
+int fdt_edit_nop_node(void *fdt, int nodeoff);
+
+#endif
@@ -18,8 +18,10 @@
  * It is recommended that platform codes call this helper in their final_init()
  *
  * @param fdt: device tree blob
+ *
+ * @return zero on success and -ve on failure
  */
-void fdt_cpu_fixup(void *fdt);
+int fdt_cpu_fixup(void *fdt);
 
 /**
  * Fix up the PLIC node in the device tree
@@ -60,6 +62,18 @@ int fdt_reserved_memory_fixup(void *fdt);
  */
 int fdt_reserved_memory_nomap_fixup(void *fdt);
 
+/**
+ * Add boot phase timestamps to the device tree
+ *
+ * This routine adds a "opensbi-boot-trace" node under the chosen node
+ * holding the boot phase timestamps recorded by the boot HART when the
+ * SBI_SCRATCH_BOOT_TRACE option is set.
+ *
+ * @param fdt: device tree blob
+ * @return zero on success and -ve on failure
+ */
+int fdt_boot_trace_fixup(void *fdt);
+
 /**
  * General device tree fix-up
  *
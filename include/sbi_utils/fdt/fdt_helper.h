@@ -33,6 +33,32 @@ struct platform_uart_data {
 	unsigned long reg_io_width;
 };
 
+/**
+ * Find next node with given compatible string using the FDT index
+ *
+ * This behaves like fdt_node_offset_by_compatible() but the lookup is
+ * done in an index of all compatible strings which is built with one
+ * pass over the device tree and rebuilt when the device tree changes.
+ */
+int fdt_index_node_by_compatible(void *fdt, int startoff,
+				 const char *compatible);
+
+/**
+ * Find node with given phandle using the FDT index
+ *
+ * This behaves like fdt_node_offset_by_phandle().
+ */
+int fdt_index_node_by_phandle(void *fdt, u32 phandle);
+
+/**
+ * Force rebuild of the FDT index on next lookup
+ *
+ * Must be called by code which modifies the device tree. Edits which
+ * keep the layout of the blob (such as same-length in-place edits of
+ * a "compatible" string) are not detected by the index on its own.
+ */
+void fdt_index_invalidate(void);
+
 const struct fdt_match *fdt_match_node(void *fdt, int nodeoff,
 				       const struct fdt_match *match_table);
 
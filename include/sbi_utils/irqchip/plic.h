@@ -26,4 +26,23 @@ void plic_set_thresh(struct plic_data *plic, u32 cntxid, u32 val);
 
 void plic_set_ie(struct plic_data *plic, u32 cntxid, u32 word_index, u32 val);
 
+/**
+ * Register an M-mode handler for a PLIC interrupt source
+ *
+ * The source is enabled in the M-mode context of the calling HART, so
+ * it must be called after plic_warm_irqchip_init() on the HART which
+ * should take the interrupt. The handler runs from the trap path with
+ * the source claimed, and it is completed once the handler returns.
+ * Handlers are meant to be registered during platform init only.
+ *
+ * @param hwirq PLIC source number
+ * @param priority PLIC priority of the source (non-zero)
+ * @param handler function called for each interrupt of the source
+ * @param priv opaque pointer passed to the handler
+ *
+ * @return 0 on success and negative error code on failure
+ */
+int plic_m_irq_register(u32 hwirq, u32 priority,
+			int (*handler)(u32 hwirq, void *priv), void *priv);
+
 #endif
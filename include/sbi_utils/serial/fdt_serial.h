@@ -15,8 +15,17 @@
 struct fdt_serial {
 	const struct fdt_match *match_table;
 	int (*init)(void *fdt, int nodeoff, const struct fdt_match *match);
+	int (*irq_init)(void);
 };
 
 int fdt_serial_init(void);
 
+/**
+ * Set up M-mode interrupts of the console, if the driver supports them
+ *
+ * Must be called on the cold boot HART after the domains are finalized
+ * and the PLIC is initialized for the HART.
+ */
+int fdt_serial_irq_init(void);
+
 #endif
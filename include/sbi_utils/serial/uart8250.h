@@ -15,4 +15,17 @@
 int uart8250_init(unsigned long base, u32 in_freq, u32 baudrate, u32 reg_shift,
 		  u32 reg_width);
 
+/**
+ * Receive characters from the M-mode PLIC interrupt of the UART
+ *
+ * Received characters are buffered by the interrupt handler instead of
+ * being polled from the UART by console_getc(). Only for a UART which
+ * S-mode does not drive itself.
+ *
+ * @param hwirq PLIC source number of the UART
+ *
+ * @return 0 on success and negative error code on failure
+ */
+int uart8250_rx_irq_init(u32 hwirq);
+
 #endif
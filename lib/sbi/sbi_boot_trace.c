@@ -0,0 +1,123 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2021 Renesas Electronics Corporation
+ */
+
+#include <sbi/riscv_asm.h>
+#include <sbi/sbi_boot_trace.h>
+#include <sbi/sbi_console.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_scratch.h>
+#include <sbi/sbi_string.h>
+
+static unsigned long boot_trace_offset;
+
+static const char *const boot_trace_phase_names[] = {
+	[SBI_BOOT_TRACE_ENTRY]		= "entry",
+	[SBI_BOOT_TRACE_HSM]		= "hsm",
+	[SBI_BOOT_TRACE_EARLY]		= "early",
+	[SBI_BOOT_TRACE_HART]		= "hart",
+	[SBI_BOOT_TRACE_CONSOLE]	= "console",
+	[SBI_BOOT_TRACE_PMU]		= "pmu",
+	[SBI_BOOT_TRACE_IRQCHIP]	= "irqchip",
+	[SBI_BOOT_TRACE_IPI]		= "ipi",
+	[SBI_BOOT_TRACE_TLB]		= "tlb",
+	[SBI_BOOT_TRACE_TIMER]		= "timer",
+	[SBI_BOOT_TRACE_ECALL]		= "ecall",
+	[SBI_BOOT_TRACE_DOMAIN]		= "domain",
+	[SBI_BOOT_TRACE_PMP]		= "pmp",
+	[SBI_BOOT_TRACE_FINAL]		= "final",
+	[SBI_BOOT_TRACE_DONE]		= "done",
+};
+
+#if __riscv_xlen == 32
+u64 sbi_boot_trace_timestamp(void)
+{
+	u32 lo, hi, tmp;
+
+	do {
+		hi = csr_read(CSR_MCYCLEH);
+		lo = csr_read(CSR_MCYCLE);
+		tmp = csr_read(CSR_MCYCLEH);
+	} while (hi != tmp);
+
+	return ((u64)hi << 32) | lo;
+}
+#else
+u64 sbi_boot_trace_timestamp(void)
+{
+	return csr_read(CSR_MCYCLE);
+}
+#endif
+
+const char *sbi_boot_trace_phase_name(u32 phase)
+{
+	if (SBI_BOOT_TRACE_PHASE_MAX <= phase)
+		return NULL;
+
+	return boot_trace_phase_names[phase];
+}
+
+void sbi_boot_trace_record_at(struct sbi_scratch *scratch, u32 phase,
+			      u64 timestamp)
+{
+	u64 *ts;
+
+	if (!boot_trace_offset || SBI_BOOT_TRACE_PHASE_MAX <= phase)
+		return;
+
+	ts = sbi_scratch_offset_ptr(scratch, boot_trace_offset);
+	ts[phase] = timestamp;
+}
+
+u64 sbi_boot_trace_get(struct sbi_scratch *scratch, u32 phase)
+{
+	u64 *ts;
+
+	if (!boot_trace_offset || SBI_BOOT_TRACE_PHASE_MAX <= phase)
+		return 0;
+
+	ts = sbi_scratch_offset_ptr(scratch, boot_trace_offset);
+	return ts[phase];
+}
+
+void sbi_boot_trace_dump(struct sbi_scratch *scratch, u32 hartid)
+{
+	u32 i;
+	u64 *ts, prev;
+
+	if (!boot_trace_offset)
+		return;
+
+	ts = sbi_scratch_offset_ptr(scratch, boot_trace_offset);
+	prev = ts[SBI_BOOT_TRACE_ENTRY];
+
+	sbi_printf("HART%u Boot Phase  : %16s %12s\n",
+		   hartid, "mcycle", "delta");
+	for (i = 0; i < SBI_BOOT_TRACE_PHASE_MAX; i++) {
+		if (!ts[i])
+			continue;
+		sbi_printf("  %-16s: %16lu %12lu\n",
+			   boot_trace_phase_names[i],
+			   (ulong)ts[i], (ulong)(ts[i] - prev));
+		prev = ts[i];
+	}
+	sbi_printf("  %-16s: %16s %12lu\n", "total", "",
+		   (ulong)(prev - ts[SBI_BOOT_TRACE_ENTRY]));
+}
+
+int sbi_boot_trace_init(struct sbi_scratch *scratch)
+{
+	u64 *ts;
+
+	boot_trace_offset = sbi_scratch_alloc_offset(
+				sizeof(*ts) * SBI_BOOT_TRACE_PHASE_MAX);
+	if (!boot_trace_offset)
+		return SBI_ENOMEM;
+
+	ts = sbi_scratch_offset_ptr(scratch, boot_trace_offset);
+	sbi_memset(ts, 0, sizeof(*ts) * SBI_BOOT_TRACE_PHASE_MAX);
+
+	return 0;
+}
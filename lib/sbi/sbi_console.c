@@ -12,6 +12,13 @@
 #include <sbi/sbi_hart.h>
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_scratch.h>
+#include <sbi/sbi_string.h>
+
+/* Size of the stack buffer used to format console output */
+#define CONSOLE_TBUF_MAX 256
+
+/* Most bytes written by one sbi_nputs() call while holding the lock */
+#define CONSOLE_NPUTS_MAX 256
 
 static const struct sbi_console_device *console_dev = NULL;
 static spinlock_t console_out_lock	       = SPIN_LOCK_INITIALIZER;
@@ -41,16 +48,58 @@ void sbi_putc(char ch)
 	}
 }
 
+static void nputs_all(const char *str, unsigned long len)
+{
+	unsigned long p = 0;
+
+	while (p < len)
+		p += console_dev->console_puts(&str[p], len - p);
+}
+
+static void nputs(const char *str, unsigned long len)
+{
+	unsigned long i, b;
+
+	if (!console_dev)
+		return;
+
+	if (!console_dev->console_puts) {
+		for (i = 0; i < len; i++)
+			sbi_putc(str[i]);
+		return;
+	}
+
+	/* Hand over whole lines with '\n' expanded to "\r\n" */
+	for (i = b = 0; i < len; i++) {
+		if (str[i] == '\n') {
+			nputs_all(&str[b], i - b);
+			nputs_all("\r\n", 2);
+			b = i + 1;
+		}
+	}
+	nputs_all(&str[b], len - b);
+}
+
 void sbi_puts(const char *str)
 {
 	spin_lock(&console_out_lock);
-	while (*str) {
-		sbi_putc(*str);
-		str++;
-	}
+	nputs(str, sbi_strlen(str));
 	spin_unlock(&console_out_lock);
 }
 
+unsigned long sbi_nputs(const char *str, unsigned long len)
+{
+	/* Other HARTs printing wait for the lock, so bound the time held */
+	if (len > CONSOLE_NPUTS_MAX)
+		len = CONSOLE_NPUTS_MAX;
+
+	spin_lock(&console_out_lock);
+	nputs(str, len);
+	spin_unlock(&console_out_lock);
+
+	return len;
+}
+
 void sbi_gets(char *s, int maxwidth, char endchar)
 {
 	int ch;
@@ -64,6 +113,22 @@ void sbi_gets(char *s, int maxwidth, char endchar)
 	*retval = '\0';
 }
 
+unsigned long sbi_ngets(char *str, unsigned long len)
+{
+	int ch;
+	unsigned long i;
+
+	/* Only return what is already available */
+	for (i = 0; i < len; i++) {
+		ch = sbi_getc();
+		if (ch < 0)
+			break;
+		str[i] = ch;
+	}
+
+	return i;
+}
+
 #define PAD_RIGHT 1
 #define PAD_ZERO 2
 #define PAD_ALTERNATE 4
@@ -72,16 +137,20 @@ void sbi_gets(char *s, int maxwidth, char endchar)
 #define va_start(v, l) __builtin_va_start((v), l)
 #define va_end __builtin_va_end
 #define va_arg __builtin_va_arg
+#define va_copy __builtin_va_copy
 typedef __builtin_va_list va_list;
 
 static void printc(char **out, u32 *out_len, char ch)
 {
 	if (out) {
 		if (*out) {
-			if (out_len && (0 < *out_len)) {
-				**out = ch;
-				++(*out);
-				(*out_len)--;
+			if (out_len) {
+				/* Always leave room for the terminating NUL */
+				if (1 < *out_len) {
+					**out = ch;
+					++(*out);
+					(*out_len)--;
+				}
 			} else {
 				**out = ch;
 				++(*out);
@@ -337,12 +406,35 @@ static int print(char **out, u32 *out_len, const char *format, va_list args)
 			++pc;
 		}
 	}
-	if (out)
+	if (out && (!out_len || *out_len))
 		**out = '\0';
 
 	return pc;
 }
 
+static int console_vprintf(const char *format, va_list args)
+{
+	char tbuf[CONSOLE_TBUF_MAX], *out = tbuf;
+	u32 out_len = sizeof(tbuf);
+	va_list args_copy;
+	int retval;
+
+	/* Format without holding the lock and then write it in bulk */
+	va_copy(args_copy, args);
+	retval = print(&out, &out_len, format, args_copy);
+	va_end(args_copy);
+
+	spin_lock(&console_out_lock);
+	if (retval < CONSOLE_TBUF_MAX)
+		nputs(tbuf, retval);
+	else
+		/* Too long for the buffer so print it directly */
+		retval = print(NULL, NULL, format, args);
+	spin_unlock(&console_out_lock);
+
+	return retval;
+}
+
 int sbi_sprintf(char *out, const char *format, ...)
 {
 	va_list args;
@@ -372,11 +464,9 @@ int sbi_printf(const char *format, ...)
 	va_list args;
 	int retval;
 
-	spin_lock(&console_out_lock);
 	va_start(args, format);
-	retval = print(NULL, NULL, format, args);
+	retval = console_vprintf(format, args);
 	va_end(args);
-	spin_unlock(&console_out_lock);
 
 	return retval;
 }
@@ -388,11 +478,8 @@ int sbi_dprintf(const char *format, ...)
 	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
 
 	va_start(args, format);
-	if (scratch->options & SBI_SCRATCH_DEBUG_PRINTS) {
-		spin_lock(&console_out_lock);
-		retval = print(NULL, NULL, format, args);
-		spin_unlock(&console_out_lock);
-	}
+	if (scratch->options & SBI_SCRATCH_DEBUG_PRINTS)
+		retval = console_vprintf(format, args);
 	va_end(args);
 
 	return retval;
@@ -402,11 +489,9 @@ void sbi_panic(const char *format, ...)
 {
 	va_list args;
 
-	spin_lock(&console_out_lock);
 	va_start(args, format);
-	print(NULL, NULL, format, args);
+	console_vprintf(format, args);
 	va_end(args);
-	spin_unlock(&console_out_lock);
 
 	sbi_hart_hang();
 }
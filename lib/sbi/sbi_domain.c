@@ -10,6 +10,7 @@
 #include <sbi/riscv_asm.h>
 #include <sbi/sbi_console.h>
 #include <sbi/sbi_domain.h>
+#include <sbi/sbi_hart.h>
 #include <sbi/sbi_hartmask.h>
 #include <sbi/sbi_hsm.h>
 #include <sbi/sbi_math.h>
@@ -29,6 +30,20 @@ static u32 root_memregs_count = 0;
 static struct sbi_domain_memregion root_fw_region;
 static struct sbi_domain_memregion root_memregs[ROOT_REGION_MAX + 1] = { 0 };
 
+#define DOMAIN_INTERVAL_MAX	(SBI_DOMAIN_MAX_INDEX * 8)
+static u32 domain_intervals_used = 0;
+static struct sbi_domain_interval domain_intervals[DOMAIN_INTERVAL_MAX];
+
+/* Last address interval hit by sbi_domain_check_addr() on a HART */
+struct domain_addr_cache {
+	const struct sbi_domain *dom;
+	unsigned long start;
+	unsigned long end;
+	u32 index;
+};
+
+static unsigned long domain_addr_cache_off;
+
 struct sbi_domain root = {
 	.name = "root",
 	.possible_harts = &root_hmask,
@@ -47,21 +62,10 @@ bool sbi_domain_is_assigned_hart(const struct sbi_domain *dom, u32 hartid)
 ulong sbi_domain_get_assigned_hartmask(const struct sbi_domain *dom,
 				       ulong hbase)
 {
-	ulong ret, bword, boff;
-
 	if (!dom)
 		return 0;
 
-	bword = BIT_WORD(hbase);
-	boff = BIT_WORD_OFFSET(hbase);
-
-	ret = sbi_hartmask_bits(&dom->assigned_harts)[bword++] >> boff;
-	if (boff && bword < BIT_WORD(SBI_HARTMASK_MAX_BITS)) {
-		ret |= (sbi_hartmask_bits(&dom->assigned_harts)[bword] &
-			(BIT(boff) - 1UL)) << (BITS_PER_LONG - boff);
-	}
-
-	return ret;
+	return sbi_hartmask_word(&dom->assigned_harts, hbase);
 }
 
 static void domain_memregion_initfw(struct sbi_domain_memregion *reg)
@@ -101,13 +105,72 @@ void sbi_domain_memregion_init(unsigned long addr,
 	}
 }
 
+static unsigned long domain_memregion_end(const struct sbi_domain_memregion *reg)
+{
+	return (reg->order < __riscv_xlen) ?
+		reg->base + ((1UL << reg->order) - 1) : -1UL;
+}
+
+static bool domain_check_flags(unsigned long rflags, unsigned long mode,
+			       unsigned long rwx, bool mmio)
+{
+	unsigned long rrwx = (mode == PRV_M ?
+		(rflags & SBI_DOMAIN_MEMREGION_M_ACCESS_MASK) :
+		(rflags & SBI_DOMAIN_MEMREGION_SU_ACCESS_MASK)
+		>> SBI_DOMAIN_MEMREGION_SU_ACCESS_SHIFT);
+
+	if ((mmio && !(rflags & SBI_DOMAIN_MEMREGION_MMIO)) ||
+	    (!mmio && (rflags & SBI_DOMAIN_MEMREGION_MMIO)))
+		return FALSE;
+
+	return ((rrwx & rwx) == rwx) ? TRUE : FALSE;
+}
+
+static const struct sbi_domain_interval *domain_find_interval(
+					const struct sbi_domain *dom,
+					unsigned long addr)
+{
+	u32 lo, hi, mid;
+	struct domain_addr_cache *cache = NULL;
+
+	if (domain_addr_cache_off) {
+		cache = sbi_scratch_offset_ptr(sbi_scratch_thishart_ptr(),
+					       domain_addr_cache_off);
+		if (cache->dom == dom &&
+		    cache->start <= addr && addr <= cache->end)
+			return &dom->intervals[cache->index];
+	}
+
+	/* Find last interval starting at or below the address */
+	lo = 0;
+	hi = dom->interval_count;
+	while (1 < hi - lo) {
+		mid = lo + (hi - lo) / 2;
+		if (dom->intervals[mid].start <= addr)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	if (cache) {
+		cache->dom = dom;
+		cache->index = lo;
+		cache->start = dom->intervals[lo].start;
+		cache->end = (lo + 1 < dom->interval_count) ?
+			     dom->intervals[lo + 1].start - 1 : -1UL;
+	}
+
+	return &dom->intervals[lo];
+}
+
 bool sbi_domain_check_addr(const struct sbi_domain *dom,
 			   unsigned long addr, unsigned long mode,
 			   unsigned long access_flags)
 {
 	bool mmio = FALSE;
 	struct sbi_domain_memregion *reg;
-	unsigned long rstart, rend, rflags, rwx = 0, rrwx = 0;
+	const struct sbi_domain_interval *iv;
+	unsigned long rwx = 0;
 
 	if (!dom)
 		return FALSE;
@@ -130,25 +193,141 @@ bool sbi_domain_check_addr(const struct sbi_domain *dom,
 	if (access_flags & SBI_DOMAIN_MMIO)
 		mmio = TRUE;
 
+	if (dom->interval_count) {
+		iv = domain_find_interval(dom, addr);
+		if (iv->covered)
+			return domain_check_flags(iv->flags, mode, rwx, mmio);
+		return (mode == PRV_M) ? TRUE : FALSE;
+	}
+
 	sbi_domain_for_each_memregion(dom, reg) {
-		rflags = reg->flags;
-		rrwx = (mode == PRV_M ?
-			(rflags & SBI_DOMAIN_MEMREGION_M_ACCESS_MASK) :
-			(rflags & SBI_DOMAIN_MEMREGION_SU_ACCESS_MASK)
-			>> SBI_DOMAIN_MEMREGION_SU_ACCESS_SHIFT);
+		if (reg->base <= addr && addr <= domain_memregion_end(reg))
+			return domain_check_flags(reg->flags, mode, rwx, mmio);
+	}
 
-		rstart = reg->base;
-		rend = (reg->order < __riscv_xlen) ?
-			rstart + ((1UL << reg->order) - 1) : -1UL;
-		if (rstart <= addr && addr <= rend) {
-			if ((mmio && !(rflags & SBI_DOMAIN_MEMREGION_MMIO)) ||
-			    (!mmio && (rflags & SBI_DOMAIN_MEMREGION_MMIO)))
-				return FALSE;
-			return ((rrwx & rwx) == rwx) ? TRUE : FALSE;
+	return (mode == PRV_M) ? TRUE : FALSE;
+}
+
+/* Get the first region boundary above the address or zero if none */
+static unsigned long domain_next_boundary(const struct sbi_domain *dom,
+					  unsigned long addr)
+{
+	const struct sbi_domain_interval *iv;
+	struct sbi_domain_memregion *reg;
+	unsigned long end, next = 0;
+
+	if (dom->interval_count) {
+		iv = domain_find_interval(dom, addr);
+		if (iv + 1 < dom->intervals + dom->interval_count)
+			return (iv + 1)->start;
+		return 0;
+	}
+
+	sbi_domain_for_each_memregion(dom, reg) {
+		end = domain_memregion_end(reg);
+		if (addr < reg->base && (!next || reg->base < next))
+			next = reg->base;
+		else if (addr <= end && end != -1UL && (!next || end + 1 < next))
+			next = end + 1;
+	}
+
+	return next;
+}
+
+bool sbi_domain_check_addr_range(const struct sbi_domain *dom,
+				 unsigned long addr, unsigned long size,
+				 unsigned long mode,
+				 unsigned long access_flags)
+{
+	unsigned long next, end = addr + size - 1;
+
+	if (!dom || !size || end < addr)
+		return FALSE;
+
+	/* Access is same everywhere between two region boundaries */
+	while (1) {
+		if (!sbi_domain_check_addr(dom, addr, mode, access_flags))
+			return FALSE;
+		next = domain_next_boundary(dom, addr);
+		if (!next || end < next)
+			return TRUE;
+		addr = next;
+	}
+}
+
+/*
+ * Build the address interval table of a domain. Region boundaries split
+ * the address space into intervals where the set of matching regions is
+ * constant so each interval gets the flags of the first matching region
+ * (same as the linear scan in sbi_domain_check_addr()). Adjacent
+ * intervals with same flags are merged afterwards.
+ */
+static void domain_build_intervals(struct sbi_domain *dom)
+{
+	u32 i, j, count = 0;
+	unsigned long end;
+	struct sbi_domain_interval *iv, tiv;
+	const struct sbi_domain_memregion *reg;
+
+	dom->intervals = NULL;
+	dom->interval_count = 0;
+
+	sbi_domain_for_each_memregion(dom, reg)
+		count++;
+	if ((DOMAIN_INTERVAL_MAX - domain_intervals_used) < (2 * count + 1)) {
+		sbi_printf("%s: %s no room for address intervals\n",
+			   __func__, dom->name);
+		return;
+	}
+	iv = &domain_intervals[domain_intervals_used];
+
+	/* Collect region boundaries */
+	count = 0;
+	iv[count++].start = 0;
+	sbi_domain_for_each_memregion(dom, reg) {
+		iv[count++].start = reg->base;
+		end = domain_memregion_end(reg);
+		if (end != -1UL)
+			iv[count++].start = end + 1;
+	}
+
+	/* Sort boundaries and drop duplicates */
+	for (i = 1; i < count; i++) {
+		tiv = iv[i];
+		for (j = i; j > 0 && tiv.start < iv[j - 1].start; j--)
+			iv[j] = iv[j - 1];
+		iv[j] = tiv;
+	}
+	for (i = j = 1; i < count; i++) {
+		if (iv[i].start != iv[j - 1].start)
+			iv[j++] = iv[i];
+	}
+	count = j;
+
+	/* Resolve region precedence for each interval */
+	for (i = 0; i < count; i++) {
+		iv[i].covered = FALSE;
+		iv[i].flags = 0;
+		sbi_domain_for_each_memregion(dom, reg) {
+			if (reg->base <= iv[i].start &&
+			    iv[i].start <= domain_memregion_end(reg)) {
+				iv[i].covered = TRUE;
+				iv[i].flags = reg->flags;
+				break;
+			}
 		}
 	}
 
-	return (mode == PRV_M) ? TRUE : FALSE;
+	/* Merge adjacent intervals with same attributes */
+	for (i = j = 1; i < count; i++) {
+		if (iv[i].covered != iv[j - 1].covered ||
+		    iv[i].flags != iv[j - 1].flags)
+			iv[j++] = iv[i];
+	}
+
+	dom->intervals = iv;
+	dom->interval_count = j;
+	domain_intervals_used += j;
 }
 
 /* Check if region complies with constraints */
@@ -336,8 +515,7 @@ void sbi_domain_dump(const struct sbi_domain *dom, const char *suffix)
 	i = 0;
 	sbi_domain_for_each_memregion(dom, reg) {
 		rstart = reg->base;
-		rend = (reg->order < __riscv_xlen) ?
-			rstart + ((1UL << reg->order) - 1) : -1UL;
+		rend = domain_memregion_end(reg);
 
 		sbi_printf("Domain%d Region%02d    %s: 0x%" PRILX "-0x%" PRILX " ",
 			   dom->index, i, suffix, rstart, rend);
@@ -580,6 +758,15 @@ int sbi_domain_finalize(struct sbi_scratch *scratch, u32 cold_hartid)
 		return rc;
 	}
 
+	/* Precompute address interval tables and PMP images of domains */
+	sbi_domain_for_each(i, dom) {
+		domain_build_intervals(dom);
+		rc = sbi_hart_pmp_image_build(scratch, dom);
+		if (rc)
+			sbi_printf("%s: %s no room for PMP image (error %d)\n",
+				   __func__, dom->name, rc);
+	}
+
 	/* Startup boot HART of domains */
 	sbi_domain_for_each(i, dom) {
 		/* Domain boot HART */
@@ -631,6 +818,10 @@ int sbi_domain_init(struct sbi_scratch *scratch, u32 cold_hartid)
 	u32 i;
 	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
 
+	/* Per-HART cache of last address interval hit (optional) */
+	domain_addr_cache_off = sbi_scratch_alloc_offset(
+					sizeof(struct domain_addr_cache));
+
 	/* Root domain firmware memory region */
 	sbi_domain_memregion_init(scratch->fw_start, scratch->fw_size, 0,
 				  &root_fw_region);
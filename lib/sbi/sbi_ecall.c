@@ -165,12 +165,21 @@ int sbi_ecall_init(void)
 	if (ret)
 		return ret;
 	ret = sbi_ecall_register_extension(&ecall_pmu);
+	if (ret)
+		return ret;
+	ret = sbi_ecall_register_extension(&ecall_dbcn);
 	if (ret)
 		return ret;
 	ret = sbi_ecall_register_extension(&ecall_legacy);
 	if (ret)
 		return ret;
 	ret = sbi_ecall_register_extension(&ecall_vendor);
+	if (ret)
+		return ret;
+	ret = sbi_ecall_register_extension(&ecall_opensbi_hsm);
+	if (ret)
+		return ret;
+	ret = sbi_ecall_register_extension(&ecall_opensbi_pmu);
 	if (ret)
 		return ret;
 
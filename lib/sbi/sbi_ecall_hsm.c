@@ -59,3 +59,34 @@ struct sbi_ecall_extension ecall_hsm = {
 	.extid_end = SBI_EXT_HSM,
 	.handle = sbi_ecall_hsm_handler,
 };
+
+static int sbi_ecall_opensbi_hsm_handler(unsigned long extid,
+					 unsigned long funcid,
+					 const struct sbi_trap_regs *regs,
+					 unsigned long *out_val,
+					 struct sbi_trap_info *out_trap)
+{
+	int ret = 0;
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	ulong smode = (csr_read(CSR_MSTATUS) & MSTATUS_MPP) >>
+			MSTATUS_MPP_SHIFT;
+
+	switch (funcid) {
+	case SBI_EXT_OPENSBI_HSM_HART_START_MANY:
+		ret = sbi_hsm_hart_start_many(scratch,
+					      sbi_domain_thishart_ptr(),
+					      regs->a0, regs->a1, regs->a2,
+					      smode, regs->a3);
+		break;
+	default:
+		ret = SBI_ENOTSUPP;
+	};
+
+	return ret;
+}
+
+struct sbi_ecall_extension ecall_opensbi_hsm = {
+	.extid_start = SBI_EXT_OPENSBI_HSM,
+	.extid_end = SBI_EXT_OPENSBI_HSM,
+	.handle = sbi_ecall_opensbi_hsm_handler,
+};
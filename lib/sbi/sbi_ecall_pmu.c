@@ -65,6 +65,11 @@ static int sbi_ecall_pmu_handler(unsigned long extid, unsigned long funcid,
 	case SBI_EXT_PMU_COUNTER_STOP:
 		ret = sbi_pmu_ctr_stop(regs->a0, regs->a1, regs->a2);
 		break;
+	case SBI_EXT_PMU_SNAPSHOT_SET_SHMEM:
+		ret = sbi_pmu_snapshot_set_shmem(regs->a0, regs->a1, regs->a2,
+				(csr_read(CSR_MSTATUS) & MSTATUS_MPP) >>
+				MSTATUS_MPP_SHIFT);
+		break;
 	default:
 		ret = SBI_ENOTSUPP;
 	};
@@ -85,3 +90,42 @@ struct sbi_ecall_extension ecall_pmu = {
 	.handle = sbi_ecall_pmu_handler,
 	.probe = sbi_ecall_pmu_probe,
 };
+
+static int sbi_ecall_opensbi_pmu_handler(unsigned long extid,
+					 unsigned long funcid,
+					 const struct sbi_trap_regs *regs,
+					 unsigned long *out_val,
+					 struct sbi_trap_info *out_trap)
+{
+	int ret = 0;
+	uint64_t temp;
+
+	switch (funcid) {
+	case SBI_EXT_OPENSBI_PMU_MUX_TIME_ENABLED:
+	case SBI_EXT_OPENSBI_PMU_MUX_TIME_RUNNING:
+		ret = sbi_pmu_mux_ctr_time(regs->a0, funcid ==
+				SBI_EXT_OPENSBI_PMU_MUX_TIME_RUNNING, &temp);
+		if (!ret)
+			*out_val = temp;
+		break;
+	case SBI_EXT_OPENSBI_PMU_MUX_TIME_ENABLED_HI:
+	case SBI_EXT_OPENSBI_PMU_MUX_TIME_RUNNING_HI:
+		ret = sbi_pmu_mux_ctr_time(regs->a0, funcid ==
+				SBI_EXT_OPENSBI_PMU_MUX_TIME_RUNNING_HI, &temp);
+#if __riscv_xlen == 32
+		if (!ret)
+			*out_val = temp >> 32;
+#endif
+		break;
+	default:
+		ret = SBI_ENOTSUPP;
+	};
+
+	return ret;
+}
+
+struct sbi_ecall_extension ecall_opensbi_pmu = {
+	.extid_start = SBI_EXT_OPENSBI_PMU,
+	.extid_end = SBI_EXT_OPENSBI_PMU,
+	.handle = sbi_ecall_opensbi_pmu_handler,
+};
@@ -37,6 +37,49 @@ struct hart_features {
 };
 static unsigned long hart_features_offset;
 
+/**
+ * Features detected on the cold boot HART along with the signature of
+ * that HART. Warm HARTs with the same signature reuse these features
+ * instead of probing CSRs through expected traps again.
+ */
+struct hart_features_profile {
+	bool valid;
+	unsigned long mvendorid;
+	unsigned long marchid;
+	unsigned long mimpid;
+	unsigned long misa;
+	struct hart_features features;
+};
+static struct hart_features_profile hart_profile;
+
+/** Number of PMP entries packed in one pmpcfg CSR */
+#define PMP_CFG_PER_CSR		(__riscv_xlen / 8)
+/** CSR number of the i-th implemented pmpcfg CSR */
+#define PMP_CFG_CSR(__i)	(CSR_PMPCFG0 + (__i) * (__riscv_xlen / 32))
+
+/** M-mode CSR snapshot used to resume from non-retentive suspend */
+struct hart_context {
+	bool valid;
+	unsigned long mstatus;
+	unsigned long medeleg;
+	unsigned long mideleg;
+	unsigned long mcounteren;
+	unsigned long scounteren;
+	unsigned long mcountinhibit;
+	/* pmpcfg CSRs followed by pmpaddr CSRs */
+	unsigned long pmp[];
+};
+static unsigned long hart_context_offset;
+static unsigned int hart_context_pmp_count;
+
+#define PMP_IMAGE_POOL_SIZE	(SBI_DOMAIN_MAX_INDEX * 24)
+static unsigned long pmp_image_pool[PMP_IMAGE_POOL_SIZE];
+static unsigned int pmp_image_pool_used;
+/* PMP features of the HART for which domain PMP images were built */
+static unsigned int pmp_image_hart_count;
+static unsigned long pmp_image_hart_gran;
+static unsigned int pmp_image_hart_addr_bits;
+
 static void mstatus_init(struct sbi_scratch *scratch)
 {
 	unsigned long mstatus_val = 0;
@@ -192,48 +235,296 @@ unsigned int sbi_hart_mhpm_bits(struct sbi_scratch *scratch)
 	return hfeatures->mhpm_bits;
 }
 
+static unsigned long hart_pmp_flags(const struct sbi_domain_memregion *reg)
+{
+	unsigned long pmp_flags = 0;
+
+	/*
+	 * If permissions are to be enforced for all modes on this
+	 * region, the lock bit should be set.
+	 */
+	if (reg->flags & SBI_DOMAIN_MEMREGION_ENF_PERMISSIONS)
+		pmp_flags |= PMP_L;
+
+	if (reg->flags & SBI_DOMAIN_MEMREGION_SU_READABLE)
+		pmp_flags |= PMP_R;
+	if (reg->flags & SBI_DOMAIN_MEMREGION_SU_WRITABLE)
+		pmp_flags |= PMP_W;
+	if (reg->flags & SBI_DOMAIN_MEMREGION_SU_EXECUTABLE)
+		pmp_flags |= PMP_X;
+
+	return pmp_flags;
+}
+
+static bool hart_pmp_region_fits(struct sbi_scratch *scratch,
+				 const struct sbi_domain_memregion *reg)
+{
+	unsigned int pmp_bits = sbi_hart_pmp_addrbits(scratch) - 1;
+	unsigned long pmp_addr_max = (1UL << pmp_bits) | ((1UL << pmp_bits) - 1);
+	unsigned int pmp_gran_log2 =
+			log2roundup(sbi_hart_pmp_granularity(scratch));
+
+	return (pmp_gran_log2 <= reg->order &&
+		(reg->base >> PMP_SHIFT) < pmp_addr_max) ? TRUE : FALSE;
+}
+
+static void hart_pmp_region_warn(const struct sbi_domain *dom,
+				 const struct sbi_domain_memregion *reg)
+{
+	sbi_printf("Can not configure pmp for domain %s", dom->name);
+	sbi_printf(" because memory region address %lx or size %lx is not in range\n",
+		    reg->base, reg->order);
+}
+
+/* Address range (with inclusive end) to be covered by PMP entries */
+struct hart_pmp_range {
+	unsigned long start;
+	unsigned long end;
+	unsigned long prot;
+};
+
+/* Only used by sbi_hart_pmp_image_build() in the coldboot path */
+static struct hart_pmp_range pmp_ranges[PMP_COUNT];
+
+/* Get log2 size of range if it can be encoded as NAPOT otherwise zero */
+static unsigned long hart_pmp_range_order(const struct hart_pmp_range *r)
+{
+	unsigned long size = r->end - r->start + 1;
+
+	if (!size)
+		return (!r->start) ? __riscv_xlen : 0;
+	if ((size & (size - 1)) || (r->start & (size - 1)) ||
+	    size < BIT(PMP_SHIFT))
+		return 0;
+
+	return log2roundup(size);
+}
+
+/* Check whether top of range can be encoded in pmpaddr of TOR entry */
+static bool hart_pmp_range_tor(struct sbi_scratch *scratch,
+			       const struct hart_pmp_range *r)
+{
+	unsigned int pmp_bits = sbi_hart_pmp_addrbits(scratch) - 1;
+	unsigned long pmp_addr_max = (1UL << pmp_bits) | ((1UL << pmp_bits) - 1);
+
+	if (r->end == -1UL)
+		return FALSE;
+
+	return ((r->end + 1) >> PMP_SHIFT) <= pmp_addr_max ? TRUE : FALSE;
+}
+
+/* Check whether two ranges overlap or touch each other */
+static bool hart_pmp_range_contiguous(const struct hart_pmp_range *a,
+				      const struct hart_pmp_range *b)
+{
+	if (a->end != -1UL && a->end + 1 < b->start)
+		return FALSE;
+	if (b->end != -1UL && b->end + 1 < a->start)
+		return FALSE;
+
+	return TRUE;
+}
+
+/*
+ * Add region to the list of ranges in PMP priority order. A region
+ * is merged into an earlier range with same permissions if they are
+ * contiguous and none of the ranges in-between overlaps the region,
+ * since merging raises the priority of the region.
+ */
+static unsigned int hart_pmp_range_add(struct sbi_scratch *scratch,
+				       unsigned int count,
+				       const struct hart_pmp_range *r)
+{
+	struct hart_pmp_range m, *t;
+	unsigned int j;
+
+	for (j = count; j > 0; j--) {
+		t = &pmp_ranges[j - 1];
+		if (t->prot == r->prot && hart_pmp_range_contiguous(t, r)) {
+			m.start = (t->start < r->start) ? t->start : r->start;
+			m.end = (t->end > r->end) ? t->end : r->end;
+			m.prot = r->prot;
+			if (hart_pmp_range_order(&m) ||
+			    hart_pmp_range_tor(scratch, &m)) {
+				*t = m;
+				return count;
+			}
+		}
+		if (t->start <= r->end && r->start <= t->end)
+			break;
+	}
+
+	if (PMP_COUNT <= count)
+		return count;
+	pmp_ranges[count] = *r;
+
+	return count + 1;
+}
+
+/* Same NAPOT encoding as pmp_set() but without touching the CSRs */
+static unsigned long hart_pmp_napot_addr(unsigned long base,
+					 unsigned long order)
+{
+	unsigned long addrmask;
+
+	if (order == PMP_SHIFT)
+		return base >> PMP_SHIFT;
+	if (order == __riscv_xlen)
+		return -1UL;
+
+	addrmask = (1UL << (order - PMP_SHIFT)) - 1;
+	return ((base >> PMP_SHIFT) & ~addrmask) | (addrmask >> 1);
+}
+
+static void hart_pmp_image_set(unsigned long *image, unsigned int cfg_count,
+			       unsigned int idx, unsigned long prot,
+			       unsigned long pmpaddr)
+{
+	image[idx / PMP_CFG_PER_CSR] |= prot << ((idx % PMP_CFG_PER_CSR) * 8);
+	image[cfg_count + idx] = pmpaddr;
+}
+
+int sbi_hart_pmp_image_build(struct sbi_scratch *scratch,
+			     struct sbi_domain *dom)
+{
+	struct sbi_domain_memregion *reg;
+	const struct hart_pmp_range *r;
+	struct hart_pmp_range nr;
+	unsigned int i, pmp_idx, cfg_count, range_count = 0, need;
+	unsigned int pmp_count = sbi_hart_pmp_count(scratch);
+	unsigned long *image, order, top = 0;
+	bool prev_tor = FALSE;
+
+	if (!dom)
+		return SBI_EINVAL;
+
+	dom->pmp_image = NULL;
+	dom->pmp_image_count = 0;
+	if (!pmp_count)
+		return 0;
+
+	/* Merge regions into as few ranges as possible */
+	sbi_domain_for_each_memregion(dom, reg) {
+		if (!hart_pmp_region_fits(scratch, reg)) {
+			hart_pmp_region_warn(dom, reg);
+			continue;
+		}
+		nr.start = reg->base;
+		nr.end = (reg->order < __riscv_xlen) ?
+			 reg->base + (BIT(reg->order) - 1) : -1UL;
+		nr.prot = hart_pmp_flags(reg);
+		range_count = hart_pmp_range_add(scratch, range_count, &nr);
+	}
+
+	/*
+	 * Count PMP entries: NAPOT ranges need one entry and other
+	 * ranges need a TOR entry preceded by an entry holding the
+	 * bottom address unless the previous TOR entry ends there.
+	 */
+	pmp_idx = 0;
+	for (i = 0; i < range_count; i++) {
+		r = &pmp_ranges[i];
+		if (hart_pmp_range_order(r))
+			need = 1;
+		else
+			need = ((!pmp_idx && !r->start) ||
+				(prev_tor && top == r->start)) ? 1 : 2;
+		if (pmp_count < pmp_idx + need)
+			break;
+		pmp_idx += need;
+		prev_tor = !hart_pmp_range_order(r);
+		top = r->end + 1;
+	}
+	range_count = i;
+	if (!pmp_idx)
+		return 0;
+
+	cfg_count = ROUNDUP(pmp_idx, PMP_CFG_PER_CSR) / PMP_CFG_PER_CSR;
+	if ((PMP_IMAGE_POOL_SIZE - pmp_image_pool_used) < (cfg_count + pmp_idx))
+		return SBI_ENOSPC;
+	image = &pmp_image_pool[pmp_image_pool_used];
+	sbi_memset(image, 0, sizeof(*image) * (cfg_count + pmp_idx));
+
+	/* Pack pmpcfg words followed by pmpaddr values */
+	pmp_idx = 0;
+	prev_tor = FALSE;
+	for (i = 0; i < range_count; i++) {
+		r = &pmp_ranges[i];
+		order = hart_pmp_range_order(r);
+		if (order) {
+			hart_pmp_image_set(image, cfg_count, pmp_idx++,
+				r->prot | ((order == PMP_SHIFT) ?
+					   PMP_A_NA4 : PMP_A_NAPOT),
+				hart_pmp_napot_addr(r->start, order));
+			prev_tor = FALSE;
+			continue;
+		}
+
+		/* Entry with address matching disabled for bottom */
+		if (!((!pmp_idx && !r->start) || (prev_tor && top == r->start)))
+			hart_pmp_image_set(image, cfg_count, pmp_idx++, 0,
+					   r->start >> PMP_SHIFT);
+		hart_pmp_image_set(image, cfg_count, pmp_idx++,
+				   r->prot | PMP_A_TOR,
+				   (r->end + 1) >> PMP_SHIFT);
+		prev_tor = TRUE;
+		top = r->end + 1;
+	}
+
+	pmp_image_pool_used += cfg_count + pmp_idx;
+	pmp_image_hart_count = pmp_count;
+	pmp_image_hart_gran = sbi_hart_pmp_granularity(scratch);
+	pmp_image_hart_addr_bits = sbi_hart_pmp_addrbits(scratch);
+	dom->pmp_image = image;
+	dom->pmp_image_count = pmp_idx;
+
+	return 0;
+}
+
+static bool hart_pmp_image_usable(struct sbi_scratch *scratch,
+				  const struct sbi_domain *dom)
+{
+	return dom->pmp_image &&
+	       pmp_image_hart_count == sbi_hart_pmp_count(scratch) &&
+	       pmp_image_hart_gran == sbi_hart_pmp_granularity(scratch) &&
+	       pmp_image_hart_addr_bits == sbi_hart_pmp_addrbits(scratch);
+}
+
 int sbi_hart_pmp_configure(struct sbi_scratch *scratch)
 {
 	struct sbi_domain_memregion *reg;
 	struct sbi_domain *dom = sbi_domain_thishart_ptr();
-	unsigned int pmp_idx = 0, pmp_flags, pmp_bits, pmp_gran_log2;
+	unsigned int i, pmp_idx = 0, cfg_count;
 	unsigned int pmp_count = sbi_hart_pmp_count(scratch);
-	unsigned long pmp_addr = 0, pmp_addr_max = 0;
 
 	if (!pmp_count)
 		return 0;
 
-	pmp_gran_log2 = log2roundup(sbi_hart_pmp_granularity(scratch));
-	pmp_bits = sbi_hart_pmp_addrbits(scratch) - 1;
-	pmp_addr_max = (1UL << pmp_bits) | ((1UL << pmp_bits) - 1);
+	/*
+	 * Write the precomputed image of the domain if it was built for
+	 * a HART with same PMP features. The addresses are written before
+	 * enabling entries, same as pmp_set().
+	 */
+	if (hart_pmp_image_usable(scratch, dom)) {
+		cfg_count = ROUNDUP(dom->pmp_image_count, PMP_CFG_PER_CSR) /
+			    PMP_CFG_PER_CSR;
+		for (i = 0; i < dom->pmp_image_count; i++)
+			csr_write_num(CSR_PMPADDR0 + i,
+				      dom->pmp_image[cfg_count + i]);
+		for (i = 0; i < cfg_count; i++)
+			csr_write_num(PMP_CFG_CSR(i), dom->pmp_image[i]);
+		return 0;
+	}
 
 	sbi_domain_for_each_memregion(dom, reg) {
 		if (pmp_count <= pmp_idx)
 			break;
 
-		pmp_flags = 0;
-		/*
-		 * If permissions are to be enforced for all modes on this
-		 * region, the lock bit should be set.
-		 */
-		if (reg->flags & SBI_DOMAIN_MEMREGION_ENF_PERMISSIONS)
-			pmp_flags |= PMP_L;
-
-		if (reg->flags & SBI_DOMAIN_MEMREGION_SU_READABLE)
-			pmp_flags |= PMP_R;
-		if (reg->flags & SBI_DOMAIN_MEMREGION_SU_WRITABLE)
-			pmp_flags |= PMP_W;
-		if (reg->flags & SBI_DOMAIN_MEMREGION_SU_EXECUTABLE)
-			pmp_flags |= PMP_X;
-
-		pmp_addr =  reg->base >> PMP_SHIFT;
-		if (pmp_gran_log2 <= reg->order && pmp_addr < pmp_addr_max)
-			pmp_set(pmp_idx++, pmp_flags, reg->base, reg->order);
-		else {
-			sbi_printf("Can not configure pmp for domain %s", dom->name);
-			sbi_printf(" because memory region address %lx or size %lx is not in range\n",
-				    reg->base, reg->order);
-		}
+		if (hart_pmp_region_fits(scratch, reg))
+			pmp_set(pmp_idx++, hart_pmp_flags(reg),
+				reg->base, reg->order);
+		else
+			hart_pmp_region_warn(dom, reg);
 	}
 
 	return 0;
@@ -513,6 +804,122 @@ __mhpm_skip:
 		hfeatures->features |= SBI_HART_HAS_TIME;
 }
 
+static unsigned int hart_context_pmp_entries(struct sbi_scratch *scratch)
+{
+	unsigned int pmp_count = sbi_hart_pmp_count(scratch);
+
+	return (pmp_count < hart_context_pmp_count) ?
+		pmp_count : hart_context_pmp_count;
+}
+
+/**
+ * Save M-mode CSRs of current HART before non-retentive suspend
+ *
+ * @param scratch pointer to the HART scratch space
+ */
+void sbi_hart_context_save(struct sbi_scratch *scratch)
+{
+	unsigned int i, pmp_count, cfg_count;
+	struct hart_context *ctx;
+
+	if (!hart_context_offset)
+		return;
+
+	ctx = sbi_scratch_offset_ptr(scratch, hart_context_offset);
+	ctx->mstatus = csr_read(CSR_MSTATUS);
+	if (misa_extension('S')) {
+		ctx->medeleg = csr_read(CSR_MEDELEG);
+		ctx->mideleg = csr_read(CSR_MIDELEG);
+	}
+	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_MCOUNTEREN))
+		ctx->mcounteren = csr_read(CSR_MCOUNTEREN);
+	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_SCOUNTEREN))
+		ctx->scounteren = csr_read(CSR_SCOUNTEREN);
+	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_MCOUNTINHIBIT))
+		ctx->mcountinhibit = csr_read(CSR_MCOUNTINHIBIT);
+
+	pmp_count = hart_context_pmp_entries(scratch);
+	cfg_count = ROUNDUP(pmp_count, PMP_CFG_PER_CSR) / PMP_CFG_PER_CSR;
+	for (i = 0; i < cfg_count; i++)
+		ctx->pmp[i] = csr_read_num(PMP_CFG_CSR(i));
+	for (i = 0; i < pmp_count; i++)
+		ctx->pmp[cfg_count + i] = csr_read_num(CSR_PMPADDR0 + i);
+
+	ctx->valid = true;
+}
+
+/**
+ * Drop the M-mode CSR snapshot of current HART
+ *
+ * Used when the HART is re-initialized instead of restored so that a
+ * stale snapshot is never restored by a later resume.
+ *
+ * @param scratch pointer to the HART scratch space
+ */
+void sbi_hart_context_discard(struct sbi_scratch *scratch)
+{
+	struct hart_context *ctx;
+
+	if (!hart_context_offset)
+		return;
+
+	ctx = sbi_scratch_offset_ptr(scratch, hart_context_offset);
+	ctx->valid = false;
+}
+
+/**
+ * Restore M-mode CSRs of current HART saved by sbi_hart_context_save()
+ *
+ * This replaces sbi_hart_reinit() and sbi_hart_pmp_configure() when
+ * resuming from non-retentive suspend. The snapshot is consumed so a
+ * later resume without a matching save falls back to full re-init.
+ *
+ * @param scratch pointer to the HART scratch space
+ * @return 0 on success and SBI_Exxx (< 0) if no snapshot is available
+ */
+int sbi_hart_context_restore(struct sbi_scratch *scratch)
+{
+	unsigned int i, pmp_count, cfg_count;
+	struct hart_context *ctx;
+	int rc;
+
+	if (!hart_context_offset)
+		return SBI_ENOTSUPP;
+
+	ctx = sbi_scratch_offset_ptr(scratch, hart_context_offset);
+	if (!ctx->valid)
+		return SBI_EINVAL;
+	ctx->valid = false;
+
+	csr_write(CSR_MSTATUS, ctx->mstatus);
+
+	/* FP registers are not retained so clear them like sbi_hart_reinit() */
+	rc = fp_init(scratch);
+	if (rc)
+		return rc;
+
+	if (misa_extension('S')) {
+		csr_write(CSR_MIDELEG, ctx->mideleg);
+		csr_write(CSR_MEDELEG, ctx->medeleg);
+	}
+	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_MCOUNTEREN))
+		csr_write(CSR_MCOUNTEREN, ctx->mcounteren);
+	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_SCOUNTEREN))
+		csr_write(CSR_SCOUNTEREN, ctx->scounteren);
+	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_MCOUNTINHIBIT))
+		csr_write(CSR_MCOUNTINHIBIT, ctx->mcountinhibit);
+
+	/* Write addresses before enabling entries, same as pmp_set() */
+	pmp_count = hart_context_pmp_entries(scratch);
+	cfg_count = ROUNDUP(pmp_count, PMP_CFG_PER_CSR) / PMP_CFG_PER_CSR;
+	for (i = 0; i < pmp_count; i++)
+		csr_write_num(CSR_PMPADDR0 + i, ctx->pmp[cfg_count + i]);
+	for (i = 0; i < cfg_count; i++)
+		csr_write_num(PMP_CFG_CSR(i), ctx->pmp[i]);
+
+	return 0;
+}
+
 int sbi_hart_reinit(struct sbi_scratch *scratch)
 {
 	int rc;
@@ -530,8 +937,41 @@ int sbi_hart_reinit(struct sbi_scratch *scratch)
 	return 0;
 }
 
+static bool hart_profile_match(void)
+{
+	return (hart_profile.valid &&
+		hart_profile.mvendorid == csr_read(CSR_MVENDORID) &&
+		hart_profile.marchid == csr_read(CSR_MARCHID) &&
+		hart_profile.mimpid == csr_read(CSR_MIMPID) &&
+		hart_profile.misa == csr_read(CSR_MISA)) ? TRUE : FALSE;
+}
+
+static void hart_init_features(struct sbi_scratch *scratch, bool cold_boot)
+{
+	struct hart_features *hfeatures =
+			sbi_scratch_offset_ptr(scratch, hart_features_offset);
+
+	if (!cold_boot && hart_profile_match()) {
+		*hfeatures = hart_profile.features;
+		return;
+	}
+
+	hart_detect_features(scratch);
+
+	if (cold_boot) {
+		hart_profile.mvendorid = csr_read(CSR_MVENDORID);
+		hart_profile.marchid = csr_read(CSR_MARCHID);
+		hart_profile.mimpid = csr_read(CSR_MIMPID);
+		hart_profile.misa = csr_read(CSR_MISA);
+		hart_profile.features = *hfeatures;
+		hart_profile.valid = TRUE;
+	}
+}
+
 int sbi_hart_init(struct sbi_scratch *scratch, bool cold_boot)
 {
+	unsigned int cfg_count;
+
 	if (cold_boot) {
 		if (misa_extension('H'))
 			sbi_hart_expected_trap = &__sbi_expected_trap_hext;
@@ -542,7 +982,20 @@ int sbi_hart_init(struct sbi_scratch *scratch, bool cold_boot)
 			return SBI_ENOMEM;
 	}
 
-	hart_detect_features(scratch);
+	hart_init_features(scratch, cold_boot);
+
+	if (cold_boot) {
+		/* Size the resume snapshot for the PMP entries we found */
+		hart_context_pmp_count = sbi_hart_pmp_count(scratch);
+		cfg_count = ROUNDUP(hart_context_pmp_count, PMP_CFG_PER_CSR) /
+			    PMP_CFG_PER_CSR;
+		hart_context_offset = sbi_scratch_alloc_offset(
+					sizeof(struct hart_context) +
+					(cfg_count + hart_context_pmp_count) *
+					sizeof(unsigned long));
+		if (!hart_context_offset)
+			return SBI_ENOMEM;
+	}
 
 	return sbi_hart_reinit(scratch);
 }
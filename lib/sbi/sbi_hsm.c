@@ -69,30 +69,37 @@ int sbi_hsm_hart_get_state(const struct sbi_domain *dom, u32 hartid)
 int sbi_hsm_hart_interruptible_mask(const struct sbi_domain *dom,
 				    ulong hbase, ulong *out_hmask)
 {
-	int hstate;
-	ulong i, hmask, dmask;
-	ulong hend = sbi_scratch_last_hartid() + 1;
-
 	*out_hmask = 0;
-	if (hend <= hbase)
+	if (sbi_scratch_last_hartid() < hbase)
 		return SBI_EINVAL;
-	if (BITS_PER_LONG < (hend - hbase))
-		hend = hbase + BITS_PER_LONG;
-
-	dmask = sbi_domain_get_assigned_hartmask(dom, hbase);
-	for (i = hbase; i < hend; i++) {
-		hmask = 1UL << (i - hbase);
-		if (dmask & hmask) {
-			hstate = __sbi_hsm_hart_get_state(i);
-			if (hstate == SBI_HSM_STATE_STARTED ||
-			    hstate == SBI_HSM_STATE_SUSPENDED)
-				*out_hmask |= hmask;
-		}
-	}
+
+	if (dom)
+		*out_hmask = sbi_hartmask_word(&dom->interruptible_harts,
+					       hbase);
 
 	return 0;
 }
 
+/* Track STARTED and SUSPENDED HARTs in the interruptible mask of domain */
+static void hsm_hart_set_interruptible(u32 hartid, bool interruptible)
+{
+	struct sbi_domain *dom;
+
+	if (SBI_HARTMASK_MAX_BITS <= hartid)
+		return;
+
+	dom = sbi_hartid_to_domain(hartid);
+	if (!dom)
+		return;
+
+	if (interruptible)
+		atomic_raw_set_bit(hartid,
+				   sbi_hartmask_bits(&dom->interruptible_harts));
+	else
+		atomic_raw_clear_bit(hartid,
+				     sbi_hartmask_bits(&dom->interruptible_harts));
+}
+
 void sbi_hsm_prepare_next_jump(struct sbi_scratch *scratch, u32 hartid)
 {
 	u32 oldstate;
@@ -103,6 +110,8 @@ void sbi_hsm_prepare_next_jump(struct sbi_scratch *scratch, u32 hartid)
 				  SBI_HSM_STATE_STARTED);
 	if (oldstate != SBI_HSM_STATE_START_PENDING)
 		sbi_hart_hang();
+
+	hsm_hart_set_interruptible(hartid, TRUE);
 }
 
 static void sbi_hsm_hart_wait(struct sbi_scratch *scratch, u32 hartid)
@@ -178,6 +187,13 @@ static int hsm_device_hart_suspend(u32 suspend_type, ulong raddr)
 	return SBI_ENOTSUPP;
 }
 
+static bool hsm_device_hart_state_lost(u32 suspend_type)
+{
+	if (hsm_dev && hsm_dev->hart_state_lost)
+		return hsm_dev->hart_state_lost(suspend_type);
+	return false;
+}
+
 int sbi_hsm_init(struct sbi_scratch *scratch, u32 hartid, bool cold_boot)
 {
 	u32 i;
@@ -289,6 +305,122 @@ int sbi_hsm_hart_start(struct sbi_scratch *scratch,
 	return 0;
 }
 
+/**
+ * Start multiple HARTs with same start address and opaque value
+ *
+ * The start address is validated once and all HARTs in the mask are
+ * moved to START_PENDING state before any of them is woken-up. HARTs
+ * which don't need a platform specific start are then woken-up using
+ * a single multicast IPI so that their warm boot runs in parallel.
+ *
+ * @param scratch pointer to sbi_scratch of current HART
+ * @param dom the domain of calling HART
+ * @param hmask the ulong HART mask of HARTs to start
+ * @param hbase the HART base ID of the HART mask
+ * @param saddr the start address
+ * @param smode the start privilege mode
+ * @param priv the opaque value passed in 'a1' register
+ * @return 0 on success and SBI_Exxx (< 0) on failure
+ * Note: if the checks or the state changes fail then none of the HARTs
+ * in the mask is started. If a platform specific start fails then the
+ * HARTs woken-up before it still start and the remaining HARTs are
+ * moved back to STOPPED state.
+ */
+int sbi_hsm_hart_start_many(struct sbi_scratch *scratch,
+			    const struct sbi_domain *dom,
+			    ulong hmask, ulong hbase, ulong saddr,
+			    ulong smode, ulong priv)
+{
+	int rc;
+	ulong i, m, ipi_mask = 0, done_mask = 0;
+	unsigned int hstate;
+	struct sbi_scratch *rscratch;
+	struct sbi_hsm_data *hdata;
+
+	/* For now, we only allow start mode to be S-mode or U-mode. */
+	if (smode != PRV_S && smode != PRV_U)
+		return SBI_EINVAL;
+	if (!hmask || hbase > sbi_scratch_last_hartid())
+		return SBI_EINVAL;
+	if (dom && (hmask & ~sbi_domain_get_assigned_hartmask(dom, hbase)))
+		return SBI_EINVAL;
+	if (dom && !sbi_domain_check_addr(dom, saddr, smode,
+					  SBI_DOMAIN_EXECUTE))
+		return SBI_EINVALID_ADDR;
+
+	/* Check all HARTs before changing the state of any of them */
+	for (i = hbase, m = hmask; m; i++, m >>= 1) {
+		if (!(m & 1UL))
+			continue;
+		if (sbi_scratch_last_hartid() < i || !sbi_hartid_to_scratch(i))
+			return SBI_EINVAL;
+		hstate = __sbi_hsm_hart_get_state(i);
+		if (hstate == SBI_HSM_STATE_STARTED)
+			return SBI_EALREADY;
+		if (hstate != SBI_HSM_STATE_STOPPED)
+			return SBI_EINVAL;
+	}
+
+	/* Move all HARTs to START_PENDING state */
+	for (i = hbase, m = hmask; m; i++, m >>= 1) {
+		if (!(m & 1UL))
+			continue;
+		rscratch = sbi_hartid_to_scratch(i);
+		hdata = sbi_scratch_offset_ptr(rscratch, hart_data_offset);
+		hstate = atomic_cmpxchg(&hdata->state, SBI_HSM_STATE_STOPPED,
+					SBI_HSM_STATE_START_PENDING);
+		if (hstate != SBI_HSM_STATE_STOPPED) {
+			rc = (hstate == SBI_HSM_STATE_STARTED) ?
+			     SBI_EALREADY : SBI_EINVAL;
+			goto fail_rollback;
+		}
+		rscratch->next_arg1 = priv;
+		rscratch->next_addr = saddr;
+		rscratch->next_mode = smode;
+		done_mask |= 1UL << (i - hbase);
+	}
+
+	/*
+	 * Wake-up all HARTs together. Each HART is removed from done_mask
+	 * once it is woken-up (or queued for the IPI) so that done_mask
+	 * only has the HARTs to roll back if a platform start fails.
+	 */
+	for (i = hbase, m = hmask; m; i++, m >>= 1) {
+		if (!(m & 1UL))
+			continue;
+		if (hsm_device_has_hart_hotplug() ||
+		   (hsm_device_has_hart_secondary_boot() &&
+		    !sbi_init_count(i))) {
+			rc = hsm_device_hart_start(i, scratch->warmboot_addr);
+			if (rc)
+				break;
+		} else {
+			ipi_mask |= 1UL << (i - hbase);
+		}
+		done_mask &= ~(1UL << (i - hbase));
+	}
+	if (ipi_mask)
+		sbi_ipi_raw_send_many(ipi_mask, hbase);
+	if (!done_mask)
+		return 0;
+
+fail_rollback:
+	/*
+	 * The HARTs in done_mask were not woken-up so move them back
+	 * to STOPPED state.
+	 */
+	for (i = hbase, m = done_mask; m; i++, m >>= 1) {
+		if (!(m & 1UL))
+			continue;
+		rscratch = sbi_hartid_to_scratch(i);
+		hdata = sbi_scratch_offset_ptr(rscratch, hart_data_offset);
+		atomic_cmpxchg(&hdata->state, SBI_HSM_STATE_START_PENDING,
+			       SBI_HSM_STATE_STOPPED);
+	}
+
+	return rc;
+}
+
 int sbi_hsm_hart_stop(struct sbi_scratch *scratch, bool exitnow)
 {
 	int oldstate;
@@ -307,6 +439,8 @@ int sbi_hsm_hart_stop(struct sbi_scratch *scratch, bool exitnow)
 		return SBI_EFAIL;
 	}
 
+	hsm_hart_set_interruptible(current_hartid(), FALSE);
+
 	if (exitnow)
 		sbi_exit(scratch);
 
@@ -342,6 +476,13 @@ static void __sbi_hsm_suspend_non_ret_save(struct sbi_scratch *scratch)
 
 	hdata->saved_mie = csr_read(CSR_MIE);
 	hdata->saved_mip = csr_read(CSR_MIP) & (MIP_SSIP | MIP_STIP);
+
+	/*
+	 * Snapshot the remaining M-mode CSRs (MSTATUS, delegation,
+	 * counter enables and PMP) so that the resume path can restore
+	 * them in one pass instead of re-initializing the HART.
+	 */
+	sbi_hart_context_save(scratch);
 }
 
 static void __sbi_hsm_suspend_non_ret_restore(struct sbi_scratch *scratch)
@@ -384,6 +525,21 @@ void sbi_hsm_hart_resume_start(struct sbi_scratch *scratch)
 			   __func__, oldstate);
 		sbi_hart_hang();
 	}
+
+	hsm_hart_set_interruptible(current_hartid(), FALSE);
+}
+
+/**
+ * Check whether resuming HART needs full re-initialization
+ * @param scratch pointer to sbi_scratch of current HART
+ * @return true if per-hart state was lost during non-retentive suspend
+ */
+bool sbi_hsm_hart_resume_state_lost(struct sbi_scratch *scratch)
+{
+	struct sbi_hsm_data *hdata = sbi_scratch_offset_ptr(scratch,
+							    hart_data_offset);
+
+	return hsm_device_hart_state_lost(hdata->suspend_type);
 }
 
 void sbi_hsm_hart_resume_finish(struct sbi_scratch *scratch)
@@ -401,6 +557,8 @@ void sbi_hsm_hart_resume_finish(struct sbi_scratch *scratch)
 		sbi_hart_hang();
 	}
 
+	hsm_hart_set_interruptible(current_hartid(), TRUE);
+
 	/*
 	 * Restore some of the M-mode CSRs which we are re-configured by
 	 * the warm-boot sequence.
@@ -11,6 +11,7 @@
 #include <sbi/riscv_atomic.h>
 #include <sbi/riscv_barrier.h>
 #include <sbi/riscv_locks.h>
+#include <sbi/sbi_boot_trace.h>
 #include <sbi/sbi_console.h>
 #include <sbi/sbi_domain.h>
 #include <sbi/sbi_ecall.h>
@@ -18,6 +19,7 @@
 #include <sbi/sbi_hartmask.h>
 #include <sbi/sbi_hsm.h>
 #include <sbi/sbi_ipi.h>
+#include <sbi/sbi_irqchip.h>
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_pmu.h>
 #include <sbi/sbi_system.h>
@@ -153,6 +155,18 @@ static void sbi_boot_print_hart(struct sbi_scratch *scratch, u32 hartid)
 	sbi_hart_delegation_dump(scratch, "Boot HART ", "         ");
 }
 
+static void sbi_boot_print_trace(struct sbi_scratch *scratch, u32 hartid)
+{
+	if (scratch->options & SBI_SCRATCH_NO_BOOT_PRINTS)
+		return;
+	if (!(scratch->options & SBI_SCRATCH_BOOT_TRACE))
+		return;
+
+	/* Boot phase timestamps */
+	sbi_boot_trace_dump(scratch, hartid);
+	sbi_printf("\n");
+}
+
 static spinlock_t coldboot_lock = SPIN_LOCK_INITIALIZER;
 static struct sbi_hartmask coldboot_wait_hmask = { 0 };
 
@@ -228,7 +242,8 @@ static void wake_coldboot_harts(struct sbi_scratch *scratch, u32 hartid)
 
 static unsigned long init_count_offset;
 
-static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
+static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid,
+				     u64 entry_ts)
 {
 	int rc;
 	unsigned long *init_count;
@@ -239,6 +254,11 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 	if (rc)
 		sbi_hart_hang();
 
+	rc = sbi_boot_trace_init(scratch);
+	if (rc)
+		sbi_hart_hang();
+	sbi_boot_trace_record_at(scratch, SBI_BOOT_TRACE_ENTRY, entry_ts);
+
 	/* Note: This has to be second thing in coldboot init sequence */
 	rc = sbi_domain_init(scratch, hartid);
 	if (rc)
@@ -251,55 +271,65 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 	rc = sbi_hsm_init(scratch, hartid, TRUE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_HSM);
 
 	rc = sbi_platform_early_init(plat, TRUE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_EARLY);
 
 	rc = sbi_hart_init(scratch, TRUE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_HART);
 
 	rc = sbi_console_init(scratch);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_CONSOLE);
 
 	rc = sbi_pmu_init(scratch, TRUE);
 	if (rc)
 		sbi_hart_hang();
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_PMU);
 
 	sbi_boot_print_banner(scratch);
 
-	rc = sbi_platform_irqchip_init(plat, TRUE);
+	rc = sbi_irqchip_init(scratch, TRUE);
 	if (rc) {
-		sbi_printf("%s: platform irqchip init failed (error %d)\n",
+		sbi_printf("%s: irqchip init failed (error %d)\n",
 			   __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_IRQCHIP);
 
 	rc = sbi_ipi_init(scratch, TRUE);
 	if (rc) {
 		sbi_printf("%s: ipi init failed (error %d)\n", __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_IPI);
 
 	rc = sbi_tlb_init(scratch, TRUE);
 	if (rc) {
 		sbi_printf("%s: tlb init failed (error %d)\n", __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_TLB);
 
 	rc = sbi_timer_init(scratch, TRUE);
 	if (rc) {
 		sbi_printf("%s: timer init failed (error %d)\n", __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_TIMER);
 
 	rc = sbi_ecall_init();
 	if (rc) {
 		sbi_printf("%s: ecall init failed (error %d)\n", __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_ECALL);
 
 	/*
 	 * Note: Finalize domains after HSM initialization so that we
@@ -313,6 +343,7 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 			   __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_DOMAIN);
 
 	rc = sbi_hart_pmp_configure(scratch);
 	if (rc) {
@@ -320,6 +351,7 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 			   __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_PMP);
 
 	/*
 	 * Note: Platform final initialization should be last so that
@@ -331,6 +363,7 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 			   __func__, rc);
 		sbi_hart_hang();
 	}
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_FINAL);
 
 	sbi_boot_print_general(scratch);
 
@@ -338,6 +371,10 @@ static void __noreturn init_coldboot(struct sbi_scratch *scratch, u32 hartid)
 
 	sbi_boot_print_hart(scratch, hartid);
 
+	sbi_boot_trace_record(scratch, SBI_BOOT_TRACE_DONE);
+
+	sbi_boot_print_trace(scratch, hartid);
+
 	wake_coldboot_harts(scratch, hartid);
 
 	init_count = sbi_scratch_offset_ptr(scratch, init_count_offset);
@@ -373,7 +410,7 @@ static void init_warm_startup(struct sbi_scratch *scratch, u32 hartid)
 	if (rc)
 		sbi_hart_hang();
 
-	rc = sbi_platform_irqchip_init(plat, FALSE);
+	rc = sbi_irqchip_init(scratch, FALSE);
 	if (rc)
 		sbi_hart_hang();
 
@@ -405,17 +442,38 @@ static void init_warm_startup(struct sbi_scratch *scratch, u32 hartid)
 
 static void init_warm_resume(struct sbi_scratch *scratch)
 {
+	bool reinit;
 	int rc;
 
 	sbi_hsm_hart_resume_start(scratch);
 
-	rc = sbi_hart_reinit(scratch);
-	if (rc)
-		sbi_hart_hang();
+	/*
+	 * Restore the M-mode CSR snapshot taken at suspend time. Only
+	 * re-probe and re-initialize the HART if the platform reports
+	 * that per-hart state was lost or there is no valid snapshot.
+	 * A snapshot which is not restored is dropped so that a later
+	 * resume does not pick it up.
+	 */
+	if (sbi_hsm_hart_resume_state_lost(scratch)) {
+		sbi_hart_context_discard(scratch);
+		reinit = TRUE;
+	} else {
+		reinit = sbi_hart_context_restore(scratch) ? TRUE : FALSE;
+	}
 
-	rc = sbi_hart_pmp_configure(scratch);
-	if (rc)
-		sbi_hart_hang();
+	if (reinit) {
+		rc = sbi_hart_init(scratch, FALSE);
+		if (rc)
+			sbi_hart_hang();
+
+		rc = sbi_irqchip_init(scratch, FALSE);
+		if (rc)
+			sbi_hart_hang();
+
+		rc = sbi_hart_pmp_configure(scratch);
+		if (rc)
+			sbi_hart_hang();
+	}
 
 	sbi_hsm_hart_resume_finish(scratch);
 }
@@ -458,6 +516,7 @@ void __noreturn sbi_init(struct sbi_scratch *scratch)
 {
 	bool next_mode_supported	= FALSE;
 	bool coldboot			= FALSE;
+	u64 entry_ts			= sbi_boot_trace_timestamp();
 	u32 hartid			= current_hartid();
 	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
 
@@ -495,7 +554,7 @@ void __noreturn sbi_init(struct sbi_scratch *scratch)
 		coldboot = TRUE;
 
 	if (coldboot)
-		init_coldboot(scratch, hartid);
+		init_coldboot(scratch, hartid, entry_ts);
 	else
 		init_warmboot(scratch, hartid);
 }
@@ -542,7 +601,7 @@ void __noreturn sbi_exit(struct sbi_scratch *scratch)
 
 	sbi_ipi_exit(scratch);
 
-	sbi_platform_irqchip_exit(plat);
+	sbi_irqchip_exit(scratch);
 
 	sbi_platform_final_exit(plat);
 
@@ -67,7 +67,7 @@ static int sbi_ipi_send(struct sbi_scratch *scratch, u32 remote_hartid,
 	if (ipi_dev && ipi_dev->ipi_send)
 		ipi_dev->ipi_send(remote_hartid);
 
-	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_IPI_SENT);
+	sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_IPI_SENT);
 
 	if (ipi_ops->sync)
 		ipi_ops->sync(scratch);
@@ -84,8 +84,8 @@ int sbi_ipi_send_many(ulong hmask, ulong hbase, u32 event, void *data)
 {
 	int rc;
 	ulong i, m;
-	struct sbi_domain *dom = sbi_domain_thishart_ptr();
 	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	struct sbi_domain *dom = sbi_hartid_to_domain(scratch->hartid);
 
 	if (hbase != -1UL) {
 		rc = sbi_hsm_hart_interruptible_mask(dom, hbase, &m);
@@ -94,17 +94,17 @@ int sbi_ipi_send_many(ulong hmask, ulong hbase, u32 event, void *data)
 		m &= hmask;
 
 		/* Send IPIs */
-		for (i = hbase; m; i++, m >>= 1) {
-			if (m & 1UL)
-				sbi_ipi_send(scratch, i, event, data);
+		for (; m; m &= m - 1) {
+			i = hbase + __ffs(m);
+			sbi_ipi_send(scratch, i, event, data);
 		}
 	} else {
 		hbase = 0;
 		while (!sbi_hsm_hart_interruptible_mask(dom, hbase, &m)) {
 			/* Send IPIs */
-			for (i = hbase; m; i++, m >>= 1) {
-				if (m & 1UL)
-					sbi_ipi_send(scratch, i, event, data);
+			for (; m; m &= m - 1) {
+				i = hbase + __ffs(m);
+				sbi_ipi_send(scratch, i, event, data);
 			}
 			hbase += BITS_PER_LONG;
 		}
@@ -178,19 +178,17 @@ int sbi_ipi_send_halt(ulong hmask, ulong hbase)
 	return sbi_ipi_send_many(hmask, hbase, ipi_halt_event, NULL);
 }
 
-void sbi_ipi_process(void)
+void sbi_ipi_process(struct sbi_scratch *scratch)
 {
 	unsigned long ipi_type;
 	unsigned int ipi_event;
 	const struct sbi_ipi_event_ops *ipi_ops;
-	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
 	struct sbi_ipi_data *ipi_data =
 			sbi_scratch_offset_ptr(scratch, ipi_data_off);
-	u32 hartid = current_hartid();
 
-	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_IPI_RECVD);
+	sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_IPI_RECVD);
 	if (ipi_dev && ipi_dev->ipi_clear)
-		ipi_dev->ipi_clear(hartid);
+		ipi_dev->ipi_clear(scratch->hartid);
 
 	ipi_type = atomic_raw_xchg_ulong(&ipi_data->ipi_type, 0);
 	ipi_event = 0;
@@ -214,6 +212,27 @@ void sbi_ipi_raw_send(u32 target_hart)
 		ipi_dev->ipi_send(target_hart);
 }
 
+void sbi_ipi_raw_send_many(ulong hmask, ulong hbase)
+{
+	ulong i;
+
+	if (!ipi_dev)
+		return;
+
+	if (ipi_dev->ipi_send_many) {
+		ipi_dev->ipi_send_many(hmask, hbase);
+		return;
+	}
+
+	if (!ipi_dev->ipi_send)
+		return;
+
+	for (i = hbase; hmask; i++, hmask >>= 1) {
+		if (hmask & 1UL)
+			ipi_dev->ipi_send(i);
+	}
+}
+
 const struct sbi_ipi_device *sbi_ipi_get_device(void)
 {
 	return ipi_dev;
@@ -233,7 +252,10 @@ int sbi_ipi_init(struct sbi_scratch *scratch, bool cold_boot)
 	struct sbi_ipi_data *ipi_data;
 
 	if (cold_boot) {
-		ipi_data_off = sbi_scratch_alloc_offset(sizeof(*ipi_data));
+		/* Written by remote HARTs so keep on its own cache line */
+		ipi_data_off = sbi_scratch_alloc_aligned_offset(
+					sizeof(*ipi_data),
+					SBI_SCRATCH_CACHELINE_SIZE);
 		if (!ipi_data_off)
 			return SBI_ENOMEM;
 		ret = sbi_ipi_event_create(&ipi_smode_ops);
@@ -275,7 +297,7 @@ void sbi_ipi_exit(struct sbi_scratch *scratch)
 	csr_clear(CSR_MIE, MIP_MSIP);
 
 	/* Process pending IPIs */
-	sbi_ipi_process();
+	sbi_ipi_process(scratch);
 
 	/* Platform exit */
 	sbi_platform_ipi_exit(sbi_platform_ptr(scratch));
@@ -10,11 +10,13 @@
 #include <sbi/riscv_asm.h>
 #include <sbi/sbi_bitops.h>
 #include <sbi/sbi_console.h>
+#include <sbi/sbi_domain.h>
 #include <sbi/sbi_hart.h>
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_pmu.h>
 #include <sbi/sbi_scratch.h>
 #include <sbi/sbi_string.h>
+#include <sbi/sbi_timer.h>
 
 /** Information about hardware counters */
 struct sbi_pmu_hw_event {
@@ -33,6 +35,12 @@ struct sbi_pmu_hw_event {
 	uint64_t select_mask;
 };
 
+/** mhpmevent select value of a hardware event */
+struct sbi_pmu_hw_event_select {
+	uint32_t eidx;
+	uint64_t select;
+};
+
 /** Representation of a firmware event */
 struct sbi_pmu_fw_event {
 	/* Event associated with the particular counter */
@@ -43,6 +51,36 @@ struct sbi_pmu_fw_event {
 
 	/* A flag indicating pmu event monitoring is started */
 	bool bStarted;
+
+	/* A flag indicating the counter wrapped since it was started */
+	bool bOverflow;
+};
+
+/** Representation of a logical counter multiplexed onto hardware counters */
+struct sbi_pmu_mux_ctr {
+	/* Event data and configuration flags passed at match time */
+	uint64_t data;
+	unsigned long cfg_flags;
+
+	/* Hardware counters which can count the event */
+	uint32_t counters;
+
+	/* Hardware counter used in the current time slice (0 if none) */
+	uint32_t hw_ctr;
+
+	/* Count accumulated over previous time slices */
+	uint64_t count;
+
+	/* Time (in timer ticks) the counter was started and was counting */
+	uint64_t time_enabled;
+	uint64_t time_running;
+
+	/* Timer value when the counter was started and last scheduled in */
+	uint64_t enabled_at;
+	uint64_t running_at;
+
+	/* A flag indicating pmu event monitoring is started */
+	bool bStarted;
 };
 
 /* Information about PMU counters as per SBI specification */
@@ -63,17 +101,57 @@ union sbi_pmu_ctr_info {
 /* Mapping between event range and possible counters  */
 static struct sbi_pmu_hw_event hw_event_map[SBI_PMU_HW_EVENT_MAX] = {0};
 
-/* counter to enabled event mapping */
-static uint32_t active_events[SBI_HARTMASK_MAX_BITS][SBI_PMU_HW_CTR_MAX + SBI_PMU_FW_CTR_MAX];
+/* Select values of hardware events (sorted by event idx once indexed) */
+static struct sbi_pmu_hw_event_select hw_event_select[SBI_PMU_HW_EVENT_SELECT_MAX];
+static uint32_t num_hw_event_selects;
+
+/* Size of the open addressing hash of raw events (power of 2) */
+#define PMU_RAW_HASH_SIZE	(SBI_PMU_HW_EVENT_MAX * 2)
+
+/*
+ * Lookup index of the event maps built by pmu_build_event_index():
+ * hw_event_map entries of event ranges sorted by range start and a hash
+ * of raw event entries keyed by (select, select_mask). Hash slots hold
+ * the hw_event_map entry + 1 so that zero means an empty slot.
+ */
+static uint8_t hw_event_ranges[SBI_PMU_HW_EVENT_MAX];
+static uint32_t num_hw_event_ranges;
+static uint8_t hw_event_raw_hash[PMU_RAW_HASH_SIZE];
+static uint64_t hw_event_raw_masks[SBI_PMU_HW_EVENT_MAX];
+static uint32_t num_hw_event_raw_masks;
+static bool hw_event_index_ready;
+
+/** Per-HART PMU state allocated in sbi_scratch */
+struct sbi_pmu_hart_state {
+	/* Contains all the information about firmwares events */
+	struct sbi_pmu_fw_event fw_event_map[SBI_PMU_FW_MAX];
+	/* Physical address of snapshot shared memory (if enabled) */
+	unsigned long snapshot_addr;
+	bool snapshot_enabled;
+	/* Logical counters multiplexed onto free hardware counters */
+	struct sbi_pmu_mux_ctr mux_ctrs[SBI_PMU_MUX_CTR_MAX];
+	/* Timer value of the last rotation and first counter to schedule */
+	uint64_t mux_last_rotate;
+	uint32_t mux_next;
+	/* counter to enabled event mapping (total_ctrs entries) */
+	uint32_t active_events[];
+};
+
+/* Offset of per-HART PMU state in sbi_scratch */
+static unsigned long pmu_hart_state_off;
 
-/* Contains all the information about firmwares events */
-static struct sbi_pmu_fw_event fw_event_map[SBI_HARTMASK_MAX_BITS][SBI_PMU_FW_EVENT_MAX] = {0};
+#define pmu_thishart_state_ptr()	\
+	((struct sbi_pmu_hart_state *)	\
+	 sbi_scratch_thishart_offset_ptr(pmu_hart_state_off))
 
 /* Maximum number of hardware events available */
 static uint32_t num_hw_events;
 /* Maximum number of hardware counters available */
 static uint32_t num_hw_ctrs;
 
+/* First counter index of multiplexed logical counters */
+static uint32_t mux_base;
+
 /* Maximum number of counters available */
 static uint32_t total_ctrs;
 
@@ -111,11 +189,12 @@ static int pmu_ctr_validate(uint32_t cidx, uint32_t *event_idx_code)
 {
 	uint32_t event_idx_val;
 	uint32_t event_idx_type;
-	u32 hartid = current_hartid();
 
-	event_idx_val = active_events[hartid][cidx];
+	if (cidx >= total_ctrs)
+		return SBI_EINVAL;
 
-	if (cidx >= total_ctrs || (event_idx_val == SBI_PMU_EVENT_IDX_INVALID))
+	event_idx_val = pmu_thishart_state_ptr()->active_events[cidx];
+	if (event_idx_val == SBI_PMU_EVENT_IDX_INVALID)
 		return SBI_EINVAL;
 
 	event_idx_type = get_cidx_type(event_idx_val);
@@ -130,11 +209,10 @@ static int pmu_ctr_validate(uint32_t cidx, uint32_t *event_idx_code)
 static int pmu_ctr_read_fw(uint32_t cidx, unsigned long *cval,
 			       uint32_t fw_evt_code)
 {
-	u32 hartid = current_hartid();
-	struct sbi_pmu_fw_event fevent;
+	struct sbi_pmu_fw_event *fevent;
 
-	fevent = fw_event_map[hartid][fw_evt_code];
-	*cval = fevent.curr_count;
+	fevent = &pmu_thishart_state_ptr()->fw_event_map[fw_evt_code];
+	*cval = fevent->curr_count;
 
 	return 0;
 }
@@ -158,6 +236,24 @@ static int pmu_ctr_read_hw(uint32_t cidx, uint64_t *cval)
 	return 0;
 }
 
+static inline bool pmu_ctr_is_mux(uint32_t cidx)
+{
+	return (mux_base <= cidx && cidx < total_ctrs) ? TRUE : FALSE;
+}
+
+static uint64_t pmu_ctr_read_mux(struct sbi_pmu_hart_state *phs,
+				 uint32_t cidx)
+{
+	struct sbi_pmu_mux_ctr *mctr = &phs->mux_ctrs[cidx - mux_base];
+	uint64_t cval64 = 0;
+
+	/* The hardware counter is cleared whenever it is scheduled in */
+	if (mctr->hw_ctr)
+		pmu_ctr_read_hw(mctr->hw_ctr, &cval64);
+
+	return mctr->count + cval64;
+}
+
 int sbi_pmu_ctr_read(uint32_t cidx, unsigned long *cval)
 {
 	int event_idx_type;
@@ -167,6 +263,8 @@ int sbi_pmu_ctr_read(uint32_t cidx, unsigned long *cval)
 	event_idx_type = pmu_ctr_validate(cidx, &event_code);
 	if (event_idx_type < 0)
 		return SBI_EINVAL;
+	else if (pmu_ctr_is_mux(cidx))
+		*cval = pmu_ctr_read_mux(pmu_thishart_state_ptr(), cidx);
 	else if (event_idx_type == SBI_PMU_EVENT_TYPE_FW)
 		pmu_ctr_read_fw(cidx, cval, event_code);
 	else
@@ -175,6 +273,126 @@ int sbi_pmu_ctr_read(uint32_t cidx, unsigned long *cval)
 	return 0;
 }
 
+static u32 pmu_raw_hash(uint64_t select, uint64_t select_mask)
+{
+	u32 h = (u32)select ^ (u32)(select >> 32) ^
+		(u32)select_mask ^ (u32)(select_mask >> 32);
+
+	h ^= h >> 16;
+	h *= 0x45d9f3b;
+	h ^= h >> 16;
+
+	return h & (PMU_RAW_HASH_SIZE - 1);
+}
+
+static void pmu_build_event_index(void)
+{
+	struct sbi_pmu_hw_event_select tsel;
+	struct sbi_pmu_hw_event *evt;
+	uint32_t i, j, h;
+	uint8_t t;
+
+	num_hw_event_ranges = 0;
+	num_hw_event_raw_masks = 0;
+	sbi_memset(hw_event_raw_hash, 0, sizeof(hw_event_raw_hash));
+
+	for (i = 0; i < num_hw_events; i++) {
+		evt = &hw_event_map[i];
+		if (evt->start_idx != SBI_PMU_EVENT_RAW_IDX) {
+			hw_event_ranges[num_hw_event_ranges++] = i;
+			continue;
+		}
+
+		for (j = 0; j < num_hw_event_raw_masks; j++) {
+			if (hw_event_raw_masks[j] == evt->select_mask)
+				break;
+		}
+		if (j == num_hw_event_raw_masks)
+			hw_event_raw_masks[num_hw_event_raw_masks++] =
+							evt->select_mask;
+
+		h = pmu_raw_hash(evt->select, evt->select_mask);
+		while (hw_event_raw_hash[h])
+			h = (h + 1) & (PMU_RAW_HASH_SIZE - 1);
+		hw_event_raw_hash[h] = i + 1;
+	}
+
+	/* Ranges never overlap so sorting by start is enough */
+	for (i = 1; i < num_hw_event_ranges; i++) {
+		t = hw_event_ranges[i];
+		for (j = i; j > 0 &&
+		     hw_event_map[hw_event_ranges[j - 1]].start_idx >
+		     hw_event_map[t].start_idx; j--)
+			hw_event_ranges[j] = hw_event_ranges[j - 1];
+		hw_event_ranges[j] = t;
+	}
+
+	/* Stable sort so that the first select value added for an event wins */
+	for (i = 1; i < num_hw_event_selects; i++) {
+		tsel = hw_event_select[i];
+		for (j = i; j > 0 && hw_event_select[j - 1].eidx > tsel.eidx; j--)
+			hw_event_select[j] = hw_event_select[j - 1];
+		hw_event_select[j] = tsel;
+	}
+
+	hw_event_index_ready = TRUE;
+}
+
+static uint32_t pmu_range_event_counters(unsigned long event_idx)
+{
+	struct sbi_pmu_hw_event *evt;
+	uint32_t lo = 0, hi = num_hw_event_ranges, mid;
+
+	/* Find the last range starting at or before the event idx */
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (hw_event_map[hw_event_ranges[mid]].start_idx <= event_idx)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (!lo)
+		return 0;
+
+	evt = &hw_event_map[hw_event_ranges[lo - 1]];
+	return (event_idx <= evt->end_idx) ? evt->counters : 0;
+}
+
+static uint32_t pmu_raw_event_counters(uint64_t data)
+{
+	struct sbi_pmu_hw_event *evt;
+	uint32_t i, h, counters = 0;
+	uint64_t select_mask;
+
+	/* The non-event map bits of data should match the selector */
+	for (i = 0; i < num_hw_event_raw_masks; i++) {
+		select_mask = hw_event_raw_masks[i];
+		h = pmu_raw_hash(data & select_mask, select_mask);
+		for (; hw_event_raw_hash[h]; h = (h + 1) & (PMU_RAW_HASH_SIZE - 1)) {
+			evt = &hw_event_map[hw_event_raw_hash[h] - 1];
+			if (evt->select_mask == select_mask &&
+			    evt->select == (data & select_mask)) {
+				counters |= evt->counters;
+				break;
+			}
+		}
+	}
+
+	return counters;
+}
+
+/* Hardware counters which can count the given event */
+static uint32_t pmu_hw_event_counters(unsigned long event_idx, uint64_t data)
+{
+	uint32_t counters = pmu_range_event_counters(event_idx);
+
+	/* For raw events, event data is used as the select value */
+	if (event_idx == SBI_PMU_EVENT_RAW_IDX)
+		counters |= pmu_raw_event_counters(data);
+
+	return counters;
+}
+
 static int pmu_add_hw_event_map(u32 eidx_start, u32 eidx_end, u32 cmap,
 				uint64_t select, uint64_t select_mask)
 {
@@ -212,6 +430,10 @@ static int pmu_add_hw_event_map(u32 eidx_start, u32 eidx_end, u32 cmap,
 	event->select = select;
 	num_hw_events++;
 
+	/* Late additions are indexed right away */
+	if (hw_event_index_ready)
+		pmu_build_event_index();
+
 	return 0;
 
 reset_event:
@@ -240,6 +462,46 @@ int sbi_pmu_add_raw_event_counter_map(uint64_t select, uint64_t select_mask, u32
 				    SBI_PMU_EVENT_RAW_IDX, cmap, select, select_mask);
 }
 
+int sbi_pmu_add_event_select(u32 eidx, uint64_t select)
+{
+	struct sbi_pmu_hw_event_select *evsel;
+
+	if (num_hw_event_selects >= SBI_PMU_HW_EVENT_SELECT_MAX) {
+		sbi_printf("Can not handle more than %d event select values\n",
+			   SBI_PMU_HW_EVENT_SELECT_MAX);
+		return SBI_EFAIL;
+	}
+
+	evsel = &hw_event_select[num_hw_event_selects++];
+	evsel->eidx = eidx;
+	evsel->select = select;
+
+	/* Late additions are indexed right away */
+	if (hw_event_index_ready)
+		pmu_build_event_index();
+
+	return 0;
+}
+
+uint64_t sbi_pmu_get_event_select(u32 eidx)
+{
+	uint32_t lo = 0, hi = num_hw_event_selects, mid;
+
+	/* Find the first select value added for the event idx */
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (hw_event_select[mid].eidx < eidx)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < num_hw_event_selects && hw_event_select[lo].eidx == eidx)
+		return hw_event_select[lo].select;
+
+	return 0;
+}
+
 static int pmu_ctr_enable_irq_hw(int ctr_idx)
 {
 	unsigned long mhpmevent_csr;
@@ -320,47 +582,66 @@ skip_inhibit_update:
 	return 0;
 }
 
-static int pmu_ctr_start_fw(uint32_t cidx, uint32_t fw_evt_code,
-			    uint64_t ival, bool ival_update)
+static u64 *pmu_snapshot_ptr(void)
 {
-	u32 hartid = current_hartid();
-	struct sbi_pmu_fw_event *fevent;
+	struct sbi_pmu_hart_state *phs = pmu_thishart_state_ptr();
 
-	fevent = &fw_event_map[hartid][fw_evt_code];
-	if (ival_update)
-		fevent->curr_count = ival;
-	fevent->bStarted = TRUE;
+	if (!phs->snapshot_enabled)
+		return NULL;
 
-	return 0;
+	return (u64 *)phs->snapshot_addr;
 }
 
-int sbi_pmu_ctr_start(unsigned long cbase, unsigned long cmask,
-		      unsigned long flags, uint64_t ival)
+static u64 pmu_ctr_snapshot_value(struct sbi_pmu_hart_state *phs,
+				  uint32_t cidx, int event_idx_type,
+				  uint32_t event_code)
 {
-	int event_idx_type;
-	uint32_t event_code;
-	unsigned long ctr_mask = cmask << cbase;
-	int ret = SBI_EINVAL;
-	bool bUpdate = FALSE;
+	uint64_t cval64 = 0;
 
-	if (__fls(ctr_mask) >= total_ctrs)
-		return ret;
+	if (pmu_ctr_is_mux(cidx))
+		return pmu_ctr_read_mux(phs, cidx);
+	if (event_idx_type == SBI_PMU_EVENT_TYPE_FW)
+		return phs->fw_event_map[event_code].curr_count;
 
-	if (flags & SBI_PMU_START_FLAG_SET_INIT_VALUE)
-		bUpdate = TRUE;
+	pmu_ctr_read_hw(cidx, &cval64);
+	return cval64;
+}
 
-	for_each_set_bit_from(cbase, &ctr_mask, total_ctrs) {
-		event_idx_type = pmu_ctr_validate(cbase, &event_code);
-		if (event_idx_type < 0)
-			/* Continue the start operation for other counters */
-			continue;
-		else if (event_idx_type == SBI_PMU_EVENT_TYPE_FW)
-			ret = pmu_ctr_start_fw(cbase, event_code, ival, bUpdate);
-		else
-			ret = pmu_ctr_start_hw(cbase, ival, bUpdate);
-	}
+static bool pmu_ctr_overflowed(struct sbi_pmu_hart_state *phs, uint32_t cidx,
+			       int event_idx_type, uint32_t event_code)
+{
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
 
-	return ret;
+	if (event_idx_type == SBI_PMU_EVENT_TYPE_FW)
+		return phs->fw_event_map[event_code].bOverflow;
+
+	/* Only programmable counters report overflow with Sscofpmf */
+	if (pmu_ctr_is_mux(cidx) || cidx < 3 || cidx > num_hw_ctrs ||
+	    !sbi_hart_has_feature(scratch, SBI_HART_HAS_SSCOFPMF))
+		return FALSE;
+
+#if __riscv_xlen == 32
+	return (csr_read_num(CSR_MHPMEVENT3H + cidx - 3) & MHPMEVENTH_OF) ?
+		TRUE : FALSE;
+#else
+	return (csr_read_num(CSR_MHPMEVENT3 + cidx - 3) & MHPMEVENT_OF) ?
+		TRUE : FALSE;
+#endif
+}
+
+static int pmu_ctr_start_fw(uint32_t cidx, uint32_t fw_evt_code,
+			    uint64_t ival, bool ival_update)
+{
+	struct sbi_pmu_fw_event *fevent;
+
+	fevent = &pmu_thishart_state_ptr()->fw_event_map[fw_evt_code];
+	if (ival_update)
+		fevent->curr_count = ival;
+	/* Like the OF bit of hardware counters, allow the next interrupt */
+	fevent->bOverflow = FALSE;
+	fevent->bStarted = TRUE;
+
+	return 0;
 }
 
 static int pmu_ctr_stop_hw(uint32_t cidx)
@@ -387,9 +668,7 @@ static int pmu_ctr_stop_hw(uint32_t cidx)
 
 static int pmu_ctr_stop_fw(uint32_t cidx, uint32_t fw_evt_code)
 {
-	u32 hartid = current_hartid();
-
-	fw_event_map[hartid][fw_evt_code].bStarted = FALSE;
+	pmu_thishart_state_ptr()->fw_event_map[fw_evt_code].bStarted = FALSE;
 
 	return 0;
 }
@@ -408,38 +687,6 @@ static int pmu_reset_hw_mhpmevent(int ctr_idx)
 	return 0;
 }
 
-int sbi_pmu_ctr_stop(unsigned long cbase, unsigned long cmask,
-		     unsigned long flag)
-{
-	u32 hartid = current_hartid();
-	int ret = SBI_EINVAL;
-	int event_idx_type;
-	uint32_t event_code;
-	unsigned long ctr_mask = cmask << cbase;
-
-	if (__fls(ctr_mask) >= total_ctrs)
-		return SBI_EINVAL;
-
-	for_each_set_bit_from(cbase, &ctr_mask, total_ctrs) {
-		event_idx_type = pmu_ctr_validate(cbase, &event_code);
-		if (event_idx_type < 0)
-			/* Continue the stop operation for other counters */
-			continue;
-
-		else if (event_idx_type == SBI_PMU_EVENT_TYPE_FW)
-			ret = pmu_ctr_stop_fw(cbase, event_code);
-		else
-			ret = pmu_ctr_stop_hw(cbase);
-
-		if (flag & SBI_PMU_STOP_FLAG_RESET) {
-			active_events[hartid][cbase] = SBI_PMU_EVENT_IDX_INVALID;
-			pmu_reset_hw_mhpmevent(cbase);
-		}
-	}
-
-	return ret;
-}
-
 static void pmu_update_inhibit_flags(unsigned long flags, uint64_t *mhpmevent_val)
 {
 	if (flags & SBI_PMU_CFG_FLAG_SET_VUINH)
@@ -483,6 +730,338 @@ static int pmu_update_hw_mhpmevent(struct sbi_pmu_hw_event *hw_evt, int ctr_idx,
 	return 0;
 }
 
+/*
+ * S-mode never configured the hardware counter backing a multiplexed
+ * counter so its overflow must not raise LCOFI. The interrupt is raised
+ * only when OF goes from 0 to 1, so the OF bit is kept set.
+ */
+static void pmu_ctr_mask_irq_hw(int ctr_idx)
+{
+	unsigned long mhpmevent_csr;
+	unsigned long of_bit;
+
+#if __riscv_xlen == 32
+	mhpmevent_csr = CSR_MHPMEVENT3H + ctr_idx - 3;
+	of_bit = MHPMEVENTH_OF;
+#else
+	mhpmevent_csr = CSR_MHPMEVENT3 + ctr_idx - 3;
+	of_bit = MHPMEVENT_OF;
+#endif
+
+	csr_write_num(mhpmevent_csr, csr_read_num(mhpmevent_csr) | of_bit);
+}
+
+static bool pmu_mux_sched_in(struct sbi_pmu_hart_state *phs, uint32_t cidx,
+			     uint64_t now)
+{
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	struct sbi_pmu_mux_ctr *mctr = &phs->mux_ctrs[cidx - mux_base];
+	unsigned long mctr_inhbt = csr_read(CSR_MCOUNTINHIBIT);
+	unsigned long ctr_mask = mctr->counters;
+	unsigned long i = 0;
+
+	/* Use any supported counter not owned by S-mode or another slot */
+	for_each_set_bit_from(i, &ctr_mask, SBI_PMU_HW_CTR_MAX) {
+		if (phs->active_events[i] != SBI_PMU_EVENT_IDX_INVALID ||
+		    !__test_bit(i, &mctr_inhbt))
+			continue;
+		if (pmu_update_hw_mhpmevent(NULL, i, mctr->cfg_flags,
+					    phs->active_events[cidx],
+					    mctr->data))
+			continue;
+
+		if (sbi_hart_has_feature(scratch, SBI_HART_HAS_SSCOFPMF))
+			pmu_ctr_mask_irq_hw(i);
+
+		/* Not pmu_ctr_start_hw() which would clear the OF bit */
+		pmu_ctr_write_hw(i, 0);
+		__clear_bit(i, &mctr_inhbt);
+		csr_write(CSR_MCOUNTINHIBIT, mctr_inhbt);
+		mctr->hw_ctr = i;
+		mctr->running_at = now;
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+static void pmu_mux_sched_out(struct sbi_pmu_mux_ctr *mctr, uint64_t now)
+{
+	uint64_t cval64 = 0;
+
+	if (!mctr->hw_ctr)
+		return;
+
+	pmu_ctr_stop_hw(mctr->hw_ctr);
+	pmu_ctr_read_hw(mctr->hw_ctr, &cval64);
+	pmu_reset_hw_mhpmevent(mctr->hw_ctr);
+
+	mctr->count += cval64;
+	mctr->time_running += now - mctr->running_at;
+	mctr->hw_ctr = 0;
+}
+
+static uint32_t pmu_mux_waiting(struct sbi_pmu_hart_state *phs)
+{
+	uint32_t i, waiting = 0;
+
+	for (i = 0; i < SBI_PMU_MUX_CTR_MAX; i++) {
+		if (phs->mux_ctrs[i].bStarted && !phs->mux_ctrs[i].hw_ctr)
+			waiting++;
+	}
+
+	return waiting;
+}
+
+static u64 pmu_mux_slice(const struct sbi_timer_device *tdev)
+{
+	return ((u64)tdev->timer_freq * SBI_PMU_MUX_INTERVAL_MS) / 1000;
+}
+
+static int pmu_ctr_start_mux(struct sbi_pmu_hart_state *phs, uint32_t cidx,
+			     uint64_t ival, bool ival_update)
+{
+	struct sbi_pmu_mux_ctr *mctr = &phs->mux_ctrs[cidx - mux_base];
+	bool rotating = pmu_mux_waiting(phs) ? TRUE : FALSE;
+	uint64_t now = sbi_timer_value();
+
+	if (mctr->bStarted)
+		return SBI_EALREADY_STARTED;
+
+	if (ival_update)
+		mctr->count = ival;
+	mctr->bStarted = TRUE;
+	mctr->enabled_at = now;
+
+	/* Count right away if a hardware counter is free */
+	if (pmu_mux_sched_in(phs, cidx, now))
+		return 0;
+
+	/* Otherwise the first time slice starts now */
+	if (!rotating)
+		phs->mux_last_rotate = now;
+	sbi_timer_event_update();
+
+	return 0;
+}
+
+static int pmu_ctr_stop_mux(struct sbi_pmu_hart_state *phs, uint32_t cidx)
+{
+	struct sbi_pmu_mux_ctr *mctr = &phs->mux_ctrs[cidx - mux_base];
+	uint64_t now = sbi_timer_value();
+
+	if (!mctr->bStarted)
+		return SBI_EALREADY_STOPPED;
+
+	mctr->time_enabled += now - mctr->enabled_at;
+	mctr->bStarted = FALSE;
+
+	/* A waiting counter may have been the last reason to rotate */
+	if (!mctr->hw_ctr) {
+		sbi_timer_event_update();
+		return 0;
+	}
+
+	pmu_mux_sched_out(mctr, now);
+
+	return 0;
+}
+
+/* The times are cleared along with the count so that the ratio holds */
+static void pmu_mux_clear(struct sbi_pmu_mux_ctr *mctr)
+{
+	uint64_t now = sbi_timer_value();
+
+	mctr->count = 0;
+	mctr->time_enabled = 0;
+	mctr->time_running = 0;
+	mctr->enabled_at = now;
+	mctr->running_at = now;
+}
+
+int sbi_pmu_mux_ctr_time(uint32_t cidx, bool running, uint64_t *time)
+{
+	struct sbi_pmu_hart_state *phs;
+	struct sbi_pmu_mux_ctr *mctr;
+	uint32_t event_code;
+	uint64_t now;
+
+	if (!pmu_ctr_is_mux(cidx) || pmu_ctr_validate(cidx, &event_code) < 0)
+		return SBI_EINVAL;
+
+	phs = pmu_thishart_state_ptr();
+	mctr = &phs->mux_ctrs[cidx - mux_base];
+	now = sbi_timer_value();
+
+	/* Include the part of the current intervals elapsed so far */
+	if (running) {
+		*time = mctr->time_running;
+		if (mctr->hw_ctr)
+			*time += now - mctr->running_at;
+	} else {
+		*time = mctr->time_enabled;
+		if (mctr->bStarted)
+			*time += now - mctr->enabled_at;
+	}
+
+	return 0;
+}
+
+u64 sbi_pmu_mux_deadline(void)
+{
+	const struct sbi_timer_device *tdev = sbi_timer_get_device();
+	struct sbi_pmu_hart_state *phs;
+
+	if (!SBI_PMU_MUX_CTR_MAX || !pmu_hart_state_off || !tdev)
+		return -1ULL;
+
+	phs = pmu_thishart_state_ptr();
+	if (!pmu_mux_waiting(phs))
+		return -1ULL;
+
+	return phs->mux_last_rotate + pmu_mux_slice(tdev);
+}
+
+void sbi_pmu_mux_tick(void)
+{
+	const struct sbi_timer_device *tdev = sbi_timer_get_device();
+	struct sbi_pmu_hart_state *phs;
+	uint32_t i, j;
+	uint64_t now;
+
+	if (!SBI_PMU_MUX_CTR_MAX || !pmu_hart_state_off || !tdev)
+		return;
+
+	/* Nothing to rotate if every started counter is already counting */
+	phs = pmu_thishart_state_ptr();
+	if (!pmu_mux_waiting(phs))
+		return;
+
+	now = sbi_timer_value();
+	if ((now - phs->mux_last_rotate) < pmu_mux_slice(tdev))
+		return;
+	phs->mux_last_rotate = now;
+
+	for (i = 0; i < SBI_PMU_MUX_CTR_MAX; i++)
+		pmu_mux_sched_out(&phs->mux_ctrs[i], now);
+
+	/* Round-robin so that every logical counter gets a time slice */
+	j = phs->mux_next;
+	for (i = 0; i < SBI_PMU_MUX_CTR_MAX; i++) {
+		if (phs->mux_ctrs[j].bStarted)
+			pmu_mux_sched_in(phs, mux_base + j, now);
+		if (++j == SBI_PMU_MUX_CTR_MAX)
+			j = 0;
+	}
+	if (++phs->mux_next == SBI_PMU_MUX_CTR_MAX)
+		phs->mux_next = 0;
+}
+
+int sbi_pmu_ctr_start(unsigned long cbase, unsigned long cmask,
+		      unsigned long flags, uint64_t ival)
+{
+	struct sbi_pmu_hart_state *phs = pmu_thishart_state_ptr();
+	int event_idx_type;
+	uint32_t event_code;
+	unsigned long ctr_mask = cmask << cbase;
+	int ret = SBI_EINVAL;
+	bool bUpdate = FALSE;
+	u64 *snapshot = NULL;
+
+	if (__fls(ctr_mask) >= total_ctrs)
+		return ret;
+
+	if (flags & SBI_PMU_START_FLAG_SET_INIT_VALUE)
+		bUpdate = TRUE;
+
+	if (flags & SBI_PMU_START_FLAG_INIT_SNAPSHOT) {
+		snapshot = pmu_snapshot_ptr();
+		if (!snapshot)
+			return SBI_ENO_SHMEM;
+		bUpdate = TRUE;
+	}
+
+	for_each_set_bit_from(cbase, &ctr_mask, total_ctrs) {
+		event_idx_type = pmu_ctr_validate(cbase, &event_code);
+		if (event_idx_type < 0)
+			/* Continue the start operation for other counters */
+			continue;
+
+		/* Initial values come from the snapshot if requested */
+		if (snapshot)
+			ival = snapshot[SBI_PMU_SNAPSHOT_VALUES_OFFSET /
+					sizeof(u64) + cbase];
+
+		if (pmu_ctr_is_mux(cbase))
+			ret = pmu_ctr_start_mux(phs, cbase, ival, bUpdate);
+		else if (event_idx_type == SBI_PMU_EVENT_TYPE_FW)
+			ret = pmu_ctr_start_fw(cbase, event_code, ival, bUpdate);
+		else
+			ret = pmu_ctr_start_hw(cbase, ival, bUpdate);
+	}
+
+	return ret;
+}
+
+int sbi_pmu_ctr_stop(unsigned long cbase, unsigned long cmask,
+		     unsigned long flag)
+{
+	struct sbi_pmu_hart_state *phs = pmu_thishart_state_ptr();
+	int ret = SBI_EINVAL;
+	int event_idx_type;
+	uint32_t event_code;
+	unsigned long ctr_mask = cmask << cbase;
+	unsigned long cidx_base = cbase;
+	u64 *snapshot = NULL, overflow = 0;
+
+	if (__fls(ctr_mask) >= total_ctrs)
+		return SBI_EINVAL;
+
+	if (flag & SBI_PMU_STOP_FLAG_TAKE_SNAPSHOT) {
+		snapshot = pmu_snapshot_ptr();
+		if (!snapshot)
+			return SBI_ENO_SHMEM;
+	}
+
+	for_each_set_bit_from(cbase, &ctr_mask, total_ctrs) {
+		event_idx_type = pmu_ctr_validate(cbase, &event_code);
+		if (event_idx_type < 0)
+			/* Continue the stop operation for other counters */
+			continue;
+
+		else if (pmu_ctr_is_mux(cbase))
+			ret = pmu_ctr_stop_mux(phs, cbase);
+		else if (event_idx_type == SBI_PMU_EVENT_TYPE_FW)
+			ret = pmu_ctr_stop_fw(cbase, event_code);
+		else
+			ret = pmu_ctr_stop_hw(cbase);
+
+		/* Save the value after stopping so that it is stable */
+		if (snapshot) {
+			snapshot[SBI_PMU_SNAPSHOT_VALUES_OFFSET / sizeof(u64) +
+				 cbase] = pmu_ctr_snapshot_value(phs, cbase,
+							event_idx_type,
+							event_code);
+			/* Overflow bits are relative to the caller's base */
+			if (pmu_ctr_overflowed(phs, cbase, event_idx_type,
+					       event_code))
+				overflow |= 1ULL << (cbase - cidx_base);
+		}
+
+		if (flag & SBI_PMU_STOP_FLAG_RESET) {
+			phs->active_events[cbase] = SBI_PMU_EVENT_IDX_INVALID;
+			if (!pmu_ctr_is_mux(cbase))
+				pmu_reset_hw_mhpmevent(cbase);
+		}
+	}
+
+	if (snapshot)
+		snapshot[SBI_PMU_SNAPSHOT_OVERFLOW_OFFSET / sizeof(u64)] =
+								overflow;
+
+	return ret;
+}
+
 static int pmu_ctr_find_fixed_fw(unsigned long evt_idx_code)
 {
 	/* Non-programmables counters are enabled always. No need to do lookup */
@@ -498,11 +1077,11 @@ static int pmu_ctr_find_hw(unsigned long cbase, unsigned long cmask, unsigned lo
 			   unsigned long event_idx, uint64_t data)
 {
 	unsigned long ctr_mask;
-	int i, ret = 0, fixed_ctr, ctr_idx = SBI_ENOTSUPP;
-	struct sbi_pmu_hw_event *temp;
+	int ret = 0, fixed_ctr, ctr_idx = SBI_ENOTSUPP;
 	unsigned long mctr_inhbt = 0;
-	u32 hartid = current_hartid();
 	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	struct sbi_pmu_hart_state *phs =
+			sbi_scratch_offset_ptr(scratch, pmu_hart_state_off);
 
 	if (cbase > num_hw_ctrs)
 		return SBI_EINVAL;
@@ -518,37 +1097,23 @@ static int pmu_ctr_find_hw(unsigned long cbase, unsigned long cmask, unsigned lo
 
 	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_MCOUNTINHIBIT))
 		mctr_inhbt = csr_read(CSR_MCOUNTINHIBIT);
-	for (i = 0; i < num_hw_events; i++) {
-		temp = &hw_event_map[i];
-		if ((temp->start_idx > event_idx && event_idx < temp->end_idx) ||
-		    (temp->start_idx < event_idx && event_idx > temp->end_idx))
-			continue;
-
-		/* For raw events, event data is used as the select value */
-		if (event_idx == SBI_PMU_EVENT_RAW_IDX) {
-			uint64_t select_mask = temp->select_mask;
 
-			/* The non-event map bits of data should match the selector */
-			if (temp->select != (data & select_mask))
-				continue;
-		}
-		/* Fixed counters should not be part of the search */
-		ctr_mask = temp->counters & (cmask << cbase) &
-			   (~SBI_PMU_FIXED_CTR_MASK);
-		for_each_set_bit_from(cbase, &ctr_mask, SBI_PMU_HW_CTR_MAX) {
-			/**
-			 * Some of the platform may not support mcountinhibit.
-			 * Checking the active_events is enough for them
-			 */
-			if (active_events[hartid][cbase] != SBI_PMU_EVENT_IDX_INVALID)
-				continue;
-			/* If mcountinhibit is supported, the bit must be enabled */
-			if ((sbi_hart_has_feature(scratch, SBI_HART_HAS_MCOUNTINHIBIT)) &&
-			    !__test_bit(cbase, &mctr_inhbt))
-				continue;
-			/* We found a valid counter that is not started yet */
-			ctr_idx = cbase;
-		}
+	/* Fixed counters should not be part of the search */
+	ctr_mask = pmu_hw_event_counters(event_idx, data) & (cmask << cbase) &
+		   (~SBI_PMU_FIXED_CTR_MASK);
+	for_each_set_bit_from(cbase, &ctr_mask, SBI_PMU_HW_CTR_MAX) {
+		/**
+		 * Some of the platform may not support mcountinhibit.
+		 * Checking the active_events is enough for them
+		 */
+		if (phs->active_events[cbase] != SBI_PMU_EVENT_IDX_INVALID)
+			continue;
+		/* If mcountinhibit is supported, the bit must be enabled */
+		if ((sbi_hart_has_feature(scratch, SBI_HART_HAS_MCOUNTINHIBIT)) &&
+		    !__test_bit(cbase, &mctr_inhbt))
+			continue;
+		/* We found a valid counter that is not started yet */
+		ctr_idx = cbase;
 	}
 
 	if (ctr_idx == SBI_ENOTSUPP) {
@@ -561,7 +1126,7 @@ static int pmu_ctr_find_hw(unsigned long cbase, unsigned long cmask, unsigned lo
 		else
 			return SBI_EFAIL;
 	}
-	ret = pmu_update_hw_mhpmevent(temp, ctr_idx, flags, event_idx, data);
+	ret = pmu_update_hw_mhpmevent(NULL, ctr_idx, flags, event_idx, data);
 
 	if (!ret)
 		ret = ctr_idx;
@@ -575,7 +1140,8 @@ static int pmu_ctr_find_hw(unsigned long cbase, unsigned long cmask, unsigned lo
  * Thus, select the first available fw counter after sanity
  * check.
  */
-static int pmu_ctr_find_fw(unsigned long cbase, unsigned long cmask, u32 hartid)
+static int pmu_ctr_find_fw(unsigned long cbase, unsigned long cmask,
+			   struct sbi_pmu_hart_state *phs)
 {
 	int i = 0;
 	int fw_base;
@@ -586,20 +1152,62 @@ static int pmu_ctr_find_fw(unsigned long cbase, unsigned long cmask, u32 hartid)
 	else
 		fw_base = cbase;
 
-	for (i = fw_base; i < total_ctrs; i++)
-		if ((active_events[hartid][i] == SBI_PMU_EVENT_IDX_INVALID) &&
+	for (i = fw_base; i < mux_base; i++)
+		if ((phs->active_events[i] == SBI_PMU_EVENT_IDX_INVALID) &&
 		    ((1UL << i) & ctr_mask))
 			return i;
 
 	return SBI_ENOTSUPP;
 }
 
+/**
+ * Any free logical counter can be used for a hardware event which did
+ * not get a hardware counter. It is given a hardware counter whenever one
+ * is free and otherwise rotated with other logical counters on timer ticks.
+ */
+static int pmu_ctr_find_mux(unsigned long cbase, unsigned long cmask,
+			    unsigned long flags, unsigned long event_idx,
+			    uint64_t data, struct sbi_pmu_hart_state *phs)
+{
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
+	unsigned long ctr_mask = cmask << cbase;
+	struct sbi_pmu_mux_ctr *mctr;
+	uint32_t counters;
+	int i;
+
+	/* Counters must be stopped between time slices */
+	if (!sbi_hart_has_feature(scratch, SBI_HART_HAS_MCOUNTINHIBIT) ||
+	    !sbi_platform_pmu_xlate_to_mhpmevent(plat, event_idx, data))
+		return SBI_ENOTSUPP;
+
+	counters = pmu_hw_event_counters(event_idx, data) &
+		   ~SBI_PMU_FIXED_CTR_MASK;
+	if (!counters)
+		return SBI_ENOTSUPP;
+
+	for (i = mux_base; i < total_ctrs; i++) {
+		if ((phs->active_events[i] != SBI_PMU_EVENT_IDX_INVALID) ||
+		    !((1UL << i) & ctr_mask))
+			continue;
+
+		mctr = &phs->mux_ctrs[i - mux_base];
+		sbi_memset(mctr, 0, sizeof(*mctr));
+		mctr->data = data;
+		mctr->cfg_flags = flags;
+		mctr->counters = counters;
+		return i;
+	}
+
+	return SBI_ENOTSUPP;
+}
+
 int sbi_pmu_ctr_cfg_match(unsigned long cidx_base, unsigned long cidx_mask,
 			  unsigned long flags, unsigned long event_idx,
 			  uint64_t event_data)
 {
 	int ctr_idx = SBI_ENOTSUPP;
-	u32 hartid = current_hartid();
+	struct sbi_pmu_hart_state *phs = pmu_thishart_state_ptr();
 	int event_type = get_cidx_type(event_idx);
 	struct sbi_pmu_fw_event *fevent;
 	uint32_t fw_evt_code;
@@ -609,12 +1217,17 @@ int sbi_pmu_ctr_cfg_match(unsigned long cidx_base, unsigned long cidx_mask,
 	if (__fls(tmp) >= total_ctrs || event_type >= SBI_PMU_EVENT_TYPE_MAX)
 		return SBI_EINVAL;
 
+	/* Firmware event code is used to index the firmware event map */
+	if (event_type == SBI_PMU_EVENT_TYPE_FW &&
+	    get_cidx_code(event_idx) >= SBI_PMU_FW_MAX)
+		return SBI_EINVAL;
+
 	if (flags & SBI_PMU_CFG_FLAG_SKIP_MATCH) {
 		/* The caller wants to skip the match because it already knows the
 		 * counter idx for the given event. Verify that the counter idx
 		 * is still valid.
 		 */
-		if (active_events[hartid][cidx_base] == SBI_PMU_EVENT_IDX_INVALID)
+		if (phs->active_events[cidx_base] == SBI_PMU_EVENT_IDX_INVALID)
 			return SBI_EINVAL;
 		ctr_idx = cidx_base;
 		goto skip_match;
@@ -622,25 +1235,33 @@ int sbi_pmu_ctr_cfg_match(unsigned long cidx_base, unsigned long cidx_mask,
 
 	if (event_type == SBI_PMU_EVENT_TYPE_FW) {
 		/* Any firmware counter can be used track any firmware event */
-		ctr_idx = pmu_ctr_find_fw(cidx_base, cidx_mask, hartid);
+		ctr_idx = pmu_ctr_find_fw(cidx_base, cidx_mask, phs);
 	} else {
 		ctr_idx = pmu_ctr_find_hw(cidx_base, cidx_mask, flags, event_idx,
 					  event_data);
+		if (ctr_idx == SBI_EFAIL)
+			ctr_idx = pmu_ctr_find_mux(cidx_base, cidx_mask, flags,
+						   event_idx, event_data, phs);
 	}
 
 	if (ctr_idx < 0)
 		return SBI_ENOTSUPP;
 
-	active_events[hartid][ctr_idx] = event_idx;
+	phs->active_events[ctr_idx] = event_idx;
 skip_match:
-	if (event_type == SBI_PMU_EVENT_TYPE_HW) {
+	if (pmu_ctr_is_mux(ctr_idx)) {
+		if (flags & SBI_PMU_CFG_FLAG_CLEAR_VALUE)
+			pmu_mux_clear(&phs->mux_ctrs[ctr_idx - mux_base]);
+		if (flags & SBI_PMU_CFG_FLAG_AUTO_START)
+			pmu_ctr_start_mux(phs, ctr_idx, 0, false);
+	} else if (event_type == SBI_PMU_EVENT_TYPE_HW) {
 		if (flags & SBI_PMU_CFG_FLAG_CLEAR_VALUE)
 			pmu_ctr_write_hw(ctr_idx, 0);
 		if (flags & SBI_PMU_CFG_FLAG_AUTO_START)
 			pmu_ctr_start_hw(ctr_idx, 0, false);
 	} else if (event_type == SBI_PMU_EVENT_TYPE_FW) {
 		fw_evt_code = get_cidx_code(event_idx);
-		fevent = &fw_event_map[hartid][fw_evt_code];
+		fevent = &phs->fw_event_map[fw_evt_code];
 		if (flags & SBI_PMU_CFG_FLAG_CLEAR_VALUE)
 			fevent->curr_count = 0;
 		if (flags & SBI_PMU_CFG_FLAG_AUTO_START)
@@ -650,26 +1271,81 @@ skip_match:
 	return ctr_idx;
 }
 
-inline int sbi_pmu_ctr_incr_fw(enum sbi_pmu_fw_event_code_id fw_id)
+static void pmu_ctr_overflow_fw(struct sbi_scratch *scratch,
+				struct sbi_pmu_hart_state *phs,
+				struct sbi_pmu_fw_event *fevent)
+{
+	/* Only the first overflow interrupts until the counter is restarted */
+	if (fevent->bOverflow)
+		return;
+	fevent->bOverflow = TRUE;
+
+	/*
+	 * Raise a local counter overflow interrupt for S-mode so that
+	 * firmware events can be sampled just like hardware events. Firmware
+	 * counters have no OF bit so S-mode can only find the overflowed
+	 * counter in the overflow bitmap of the snapshot shared memory.
+	 */
+	if (phs->snapshot_enabled &&
+	    sbi_hart_has_feature(scratch, SBI_HART_HAS_SSCOFPMF))
+		csr_set(CSR_MIP, MIP_LCOFIP);
+}
+
+inline int sbi_pmu_ctr_incr_fw(struct sbi_scratch *scratch,
+			       enum sbi_pmu_fw_event_code_id fw_id)
 {
-	u32 hartid = current_hartid();
+	struct sbi_pmu_hart_state *phs;
 	struct sbi_pmu_fw_event *fevent;
 
-	if (unlikely(fw_id >= SBI_PMU_FW_MAX))
+	if (unlikely(fw_id >= SBI_PMU_FW_MAX || !pmu_hart_state_off))
 		return SBI_EINVAL;
 
-	fevent = &fw_event_map[hartid][fw_id];
+	phs = sbi_scratch_offset_ptr(scratch, pmu_hart_state_off);
+	fevent = &phs->fw_event_map[fw_id];
 
 	/* PMU counters will be only enabled during performance debugging */
-	if (unlikely(fevent->bStarted))
-		fevent->curr_count++;
+	if (unlikely(fevent->bStarted)) {
+		/* Firmware counters are XLEN bits wide */
+		if (unlikely(!++fevent->curr_count))
+			pmu_ctr_overflow_fw(scratch, phs, fevent);
+	}
+
+	return 0;
+}
+
+int sbi_pmu_snapshot_set_shmem(unsigned long shmem_lo, unsigned long shmem_hi,
+				unsigned long flags, unsigned long smode)
+{
+	struct sbi_pmu_hart_state *phs = pmu_thishart_state_ptr();
+
+	if (flags)
+		return SBI_EINVAL;
+
+	/* All ones physical address disables the snapshot */
+	if (shmem_lo == -1UL && shmem_hi == -1UL) {
+		phs->snapshot_enabled = FALSE;
+		return 0;
+	}
+
+	/* Address must fit in XLEN bits and be page aligned */
+	if (shmem_hi || (shmem_lo & (SBI_PMU_SNAPSHOT_SIZE - 1)))
+		return SBI_EINVAL;
+
+	if (!sbi_domain_check_addr_range(sbi_domain_thishart_ptr(), shmem_lo,
+					 SBI_PMU_SNAPSHOT_SIZE, smode,
+					 SBI_DOMAIN_READ | SBI_DOMAIN_WRITE))
+		return SBI_EINVALID_ADDR;
+
+	phs->snapshot_addr = shmem_lo;
+	phs->snapshot_enabled = TRUE;
+	sbi_memset((void *)shmem_lo, 0, SBI_PMU_SNAPSHOT_SIZE);
 
 	return 0;
 }
 
 unsigned long sbi_pmu_num_ctr(void)
 {
-	return (num_hw_ctrs + SBI_PMU_FW_CTR_MAX);
+	return total_ctrs;
 }
 
 int sbi_pmu_ctr_get_info(uint32_t cidx, unsigned long *ctr_info)
@@ -691,7 +1367,7 @@ int sbi_pmu_ctr_get_info(uint32_t cidx, unsigned long *ctr_info)
 		else
 			cinfo.width = sbi_hart_mhpm_bits(scratch) - 1;
 	} else {
-		/* it's a firmware counter */
+		/* Firmware and multiplexed counters are both read via SBI */
 		cinfo.type = SBI_PMU_CTR_TYPE_FW;
 		/* Firmware counters are XLEN bits wide */
 		cinfo.width = BITS_PER_LONG - 1;
@@ -702,52 +1378,62 @@ int sbi_pmu_ctr_get_info(uint32_t cidx, unsigned long *ctr_info)
 	return 0;
 }
 
-static void pmu_reset_event_map(u32 hartid)
+static void pmu_reset_event_map(struct sbi_pmu_hart_state *phs)
 {
 	int j;
 
 	/* Initialize the counter to event mapping table */
 	for (j = 3; j < total_ctrs; j++)
-		active_events[hartid][j] = SBI_PMU_EVENT_IDX_INVALID;
-	for (j = 0; j < SBI_PMU_FW_CTR_MAX; j++)
-		sbi_memset(&fw_event_map[hartid][j], 0,
-			   sizeof(struct sbi_pmu_fw_event));
+		phs->active_events[j] = SBI_PMU_EVENT_IDX_INVALID;
+	sbi_memset(phs->fw_event_map, 0, sizeof(phs->fw_event_map));
+	phs->snapshot_enabled = FALSE;
+	sbi_memset(phs->mux_ctrs, 0, sizeof(phs->mux_ctrs));
+	phs->mux_last_rotate = 0;
+	phs->mux_next = 0;
 }
 
 void sbi_pmu_exit(struct sbi_scratch *scratch)
 {
-	u32 hartid = current_hartid();
-
 	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_MCOUNTINHIBIT))
 		csr_write(CSR_MCOUNTINHIBIT, 0xFFFFFFF8);
 
 	csr_write(CSR_MCOUNTEREN, -1);
-	pmu_reset_event_map(hartid);
+	pmu_reset_event_map(sbi_scratch_offset_ptr(scratch,
+						   pmu_hart_state_off));
 }
 
 int sbi_pmu_init(struct sbi_scratch *scratch, bool cold_boot)
 {
 	const struct sbi_platform *plat;
-	u32 hartid = current_hartid();
+	struct sbi_pmu_hart_state *phs;
 
 	if (cold_boot) {
 		plat = sbi_platform_ptr(scratch);
 		/* Initialize hw pmu events */
 		sbi_platform_pmu_init(plat);
+		pmu_build_event_index();
 
 		/* mcycle & minstret is available always */
 		num_hw_ctrs = sbi_hart_mhpm_count(scratch) + 2;
-		total_ctrs = num_hw_ctrs + SBI_PMU_FW_CTR_MAX;
+		mux_base = num_hw_ctrs + SBI_PMU_FW_CTR_MAX;
+		total_ctrs = mux_base + SBI_PMU_MUX_CTR_MAX;
+
+		/* Per-HART state sized by the actual number of counters */
+		pmu_hart_state_off = sbi_scratch_alloc_offset(sizeof(*phs) +
+					total_ctrs * sizeof(phs->active_events[0]));
+		if (!pmu_hart_state_off)
+			return SBI_ENOMEM;
 	}
 
-	pmu_reset_event_map(hartid);
+	phs = sbi_scratch_offset_ptr(scratch, pmu_hart_state_off);
+	pmu_reset_event_map(phs);
 
 	/* First three counters are fixed by the priv spec and we enable it by default */
-	active_events[hartid][0] = SBI_PMU_EVENT_TYPE_HW << SBI_PMU_EVENT_IDX_OFFSET |
-				   SBI_PMU_HW_CPU_CYCLES;
-	active_events[hartid][1] = SBI_PMU_EVENT_IDX_INVALID;
-	active_events[hartid][2] = SBI_PMU_EVENT_TYPE_HW << SBI_PMU_EVENT_IDX_OFFSET |
-				   SBI_PMU_HW_INSTRUCTIONS;
+	phs->active_events[0] = SBI_PMU_EVENT_TYPE_HW << SBI_PMU_EVENT_IDX_OFFSET |
+				SBI_PMU_HW_CPU_CYCLES;
+	phs->active_events[1] = SBI_PMU_EVENT_IDX_INVALID;
+	phs->active_events[2] = SBI_PMU_EVENT_TYPE_HW << SBI_PMU_EVENT_IDX_OFFSET |
+				SBI_PMU_HW_INSTRUCTIONS;
 
 	return 0;
 }
@@ -20,6 +20,20 @@ struct sbi_scratch *hartid_to_scratch_table[SBI_HARTMASK_MAX_BITS] = { 0 };
 static spinlock_t extra_lock = SPIN_LOCK_INITIALIZER;
 static unsigned long extra_offset = SBI_SCRATCH_EXTRA_SPACE_OFFSET;
 
+/*
+ * Blocks of extra space below extra_offset sorted by offset. Each
+ * block is either allocated or free and adjacent free blocks are
+ * always merged.
+ */
+#define EXTRA_BLOCK_MAX		64
+struct extra_block {
+	unsigned long offset;
+	unsigned long size;
+	bool free;
+};
+static u32 extra_block_count;
+static struct extra_block extra_blocks[EXTRA_BLOCK_MAX];
+
 typedef struct sbi_scratch *(*hartid2scratch)(ulong hartid, ulong hartindex);
 
 int sbi_scratch_init(struct sbi_scratch *scratch)
@@ -33,44 +47,128 @@ int sbi_scratch_init(struct sbi_scratch *scratch)
 		hartid_to_scratch_table[i] =
 			((hartid2scratch)scratch->hartid_to_scratch)(i,
 					sbi_platform_hart_index(plat, i));
-		if (hartid_to_scratch_table[i])
+		if (hartid_to_scratch_table[i]) {
+			hartid_to_scratch_table[i]->hartid = i;
 			last_hartid_having_scratch = i;
+		}
 	}
 
 	return 0;
 }
 
-unsigned long sbi_scratch_alloc_offset(unsigned long size)
+/* Caller must make sure there is room. Must hold extra_lock. */
+static void extra_block_insert(u32 idx, unsigned long offset,
+			       unsigned long size, bool free)
+{
+	u32 i;
+
+	for (i = extra_block_count; i > idx; i--)
+		extra_blocks[i] = extra_blocks[i - 1];
+	extra_blocks[idx].offset = offset;
+	extra_blocks[idx].size = size;
+	extra_blocks[idx].free = free;
+	extra_block_count++;
+}
+
+static void extra_block_remove(u32 idx)
+{
+	u32 i;
+
+	extra_block_count--;
+	for (i = idx; i < extra_block_count; i++)
+		extra_blocks[i] = extra_blocks[i + 1];
+}
+
+/* Carve an allocation out of a free block. Must hold extra_lock. */
+static unsigned long extra_alloc_from_free(unsigned long size,
+					   unsigned long align)
+{
+	u32 i;
+	unsigned long start, end;
+	struct extra_block *blk;
+
+	for (i = 0; i < extra_block_count; i++) {
+		blk = &extra_blocks[i];
+		if (!blk->free)
+			continue;
+
+		start = ROUNDUP(blk->offset, align);
+		end = blk->offset + blk->size;
+		if (end < start || (end - start) < size)
+			continue;
+		if (EXTRA_BLOCK_MAX < extra_block_count +
+				      (start + size < end) + (blk->offset < start))
+			return 0;
+
+		/* Split off the unused tail and head as free blocks */
+		if (start + size < end)
+			extra_block_insert(i + 1, start + size,
+					   end - start - size, TRUE);
+		if (blk->offset < start) {
+			extra_block_insert(i + 1, start, size, FALSE);
+			blk->size = start - blk->offset;
+		} else {
+			blk->size = size;
+			blk->free = FALSE;
+		}
+
+		return start;
+	}
+
+	return 0;
+}
+
+/* Allocate from space above all blocks. Must hold extra_lock. */
+static unsigned long extra_alloc_from_top(unsigned long size,
+					  unsigned long align)
+{
+	u32 count = extra_block_count;
+	unsigned long start = ROUNDUP(extra_offset, align);
+
+	if (SBI_SCRATCH_SIZE < start || (SBI_SCRATCH_SIZE - start) < size)
+		return 0;
+	if (EXTRA_BLOCK_MAX < count + 2)
+		return 0;
+
+	/* Keep the alignment gap as a free block */
+	if (extra_offset < start) {
+		if (count && extra_blocks[count - 1].free)
+			extra_blocks[count - 1].size += start - extra_offset;
+		else
+			extra_block_insert(count, extra_offset,
+					   start - extra_offset, TRUE);
+	}
+
+	extra_block_insert(extra_block_count, start, size, FALSE);
+	extra_offset = start + size;
+
+	return start;
+}
+
+unsigned long sbi_scratch_alloc_aligned_offset(unsigned long size,
+					       unsigned long align)
 {
 	u32 i;
 	void *ptr;
 	unsigned long ret = 0;
 	struct sbi_scratch *rscratch;
 
-	/*
-	 * We have a simple brain-dead allocator which never expects
-	 * anything to be free-ed hence it keeps incrementing the
-	 * next allocation offset until it runs-out of space.
-	 *
-	 * In future, we will have more sophisticated allocator which
-	 * will allow us to re-claim free-ed space.
-	 */
-
 	if (!size)
 		return 0;
 
-	if (size & (__SIZEOF_POINTER__ - 1))
-		size = (size & ~(__SIZEOF_POINTER__ - 1)) + __SIZEOF_POINTER__;
+	if (align < __SIZEOF_POINTER__)
+		align = __SIZEOF_POINTER__;
+	if (align & (align - 1))
+		return 0;
 
-	spin_lock(&extra_lock);
+	size = ROUNDUP(size, align);
 
-	if (SBI_SCRATCH_SIZE < (extra_offset + size))
-		goto done;
+	spin_lock(&extra_lock);
 
-	ret = extra_offset;
-	extra_offset += size;
+	ret = extra_alloc_from_free(size, align);
+	if (!ret)
+		ret = extra_alloc_from_top(size, align);
 
-done:
 	spin_unlock(&extra_lock);
 
 	if (ret) {
@@ -86,14 +184,48 @@ done:
 	return ret;
 }
 
+unsigned long sbi_scratch_alloc_offset(unsigned long size)
+{
+	return sbi_scratch_alloc_aligned_offset(size, __SIZEOF_POINTER__);
+}
+
 void sbi_scratch_free_offset(unsigned long offset)
 {
+	u32 i;
+	struct extra_block *blk;
+
 	if ((offset < SBI_SCRATCH_EXTRA_SPACE_OFFSET) ||
 	    (SBI_SCRATCH_SIZE <= offset))
 		return;
 
-	/*
-	 * We don't actually free-up because it's a simple
-	 * brain-dead allocator.
-	 */
+	spin_lock(&extra_lock);
+
+	for (i = 0; i < extra_block_count; i++) {
+		if (extra_blocks[i].offset == offset)
+			break;
+	}
+	if (i == extra_block_count || extra_blocks[i].free)
+		goto done;
+
+	/* Merge with next and previous free blocks */
+	blk = &extra_blocks[i];
+	blk->free = TRUE;
+	if (i + 1 < extra_block_count && extra_blocks[i + 1].free) {
+		blk->size += extra_blocks[i + 1].size;
+		extra_block_remove(i + 1);
+	}
+	if (i && extra_blocks[i - 1].free) {
+		extra_blocks[i - 1].size += blk->size;
+		extra_block_remove(i);
+		i--;
+	}
+
+	/* Give back free space at the top */
+	if (i == extra_block_count - 1) {
+		extra_offset = extra_blocks[i].offset;
+		extra_block_remove(i);
+	}
+
+done:
+	spin_unlock(&extra_lock);
 }
@@ -14,6 +14,20 @@
 
 #include <sbi/sbi_string.h>
 
+#ifdef __riscv_zbb
+/* Zero bytes of a word become 0x00 and all other bytes become 0xff */
+static inline unsigned long orc_b(unsigned long word)
+{
+	unsigned long ret;
+
+	__asm__ ("orc.b %0, %1" : "=r"(ret) : "r"(word));
+
+	return ret;
+}
+
+#define WORD_MASK	(sizeof(unsigned long) - 1)
+#endif
+
 /*
   Provides sbi_strcmp for the completeness of supporting string functions.
   it is not recommended to use sbi_strcmp() but use sbi_strncmp instead.
@@ -29,6 +43,23 @@ int sbi_strcmp(const char *a, const char *b)
 
 int sbi_strncmp(const char *a, const char *b, size_t count)
 {
+#ifdef __riscv_zbb
+	const unsigned long *wa = (const unsigned long *)a;
+	const unsigned long *wb = (const unsigned long *)b;
+
+	/* Skip equal words without a NUL while both strings are aligned */
+	if (!(((unsigned long)a | (unsigned long)b) & WORD_MASK)) {
+		while (count > WORD_MASK && *wa == *wb &&
+		       orc_b(*wa) == -1UL) {
+			wa++;
+			wb++;
+			count -= sizeof(unsigned long);
+		}
+		a = (const char *)wa;
+		b = (const char *)wb;
+	}
+#endif
+
 	/* search first diff or end of string */
 	for (; count > 0 && *a == *b && *a != '\0'; a++, b++, count--)
 		;
@@ -42,6 +73,22 @@ int sbi_strncmp(const char *a, const char *b, size_t count)
 
 size_t sbi_strlen(const char *str)
 {
+#ifdef __riscv_zbb
+	const char *s = str;
+	const unsigned long *w;
+	unsigned long t;
+
+	for (; (unsigned long)s & WORD_MASK; s++) {
+		if (*s == '\0')
+			return s - str;
+	}
+
+	/* Aligned words never cross a page, so reading past the NUL is safe */
+	for (w = (const unsigned long *)s; (t = orc_b(*w)) == -1UL; w++)
+		;
+
+	return (const char *)w - str + __builtin_ctzl(~t) / 8;
+#else
 	unsigned long ret = 0;
 
 	while (*str != '\0') {
@@ -50,6 +97,7 @@ size_t sbi_strlen(const char *str)
 	}
 
 	return ret;
+#endif
 }
 
 size_t sbi_strnlen(const char *str, size_t count)
@@ -19,6 +19,7 @@
 #include <sbi/sbi_timer.h>
 
 static unsigned long time_delta_off;
+static unsigned long time_next_event_off;
 static u64 (*get_time_val)(void);
 static const struct sbi_timer_device *timer_dev = NULL;
 
@@ -121,19 +122,65 @@ void sbi_timer_set_delta_upper(ulong delta_upper)
 	*time_delta |= ((u64)delta_upper << 32);
 }
 
-void sbi_timer_event_start(u64 next_event)
+/*
+ * Program the earlier of the S-mode timer event and the firmware deadline
+ * of multiplexed PMU counters. All ones means no event is pending.
+ */
+static void timer_event_program(u64 next_event)
 {
-	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_SET_TIMER);
+	u64 pmu_deadline = sbi_pmu_mux_deadline();
+
+	if (pmu_deadline < next_event)
+		next_event = pmu_deadline;
+
+	if (next_event == -1ULL) {
+		csr_clear(CSR_MIE, MIP_MTIP);
+		return;
+	}
+
 	if (timer_dev && timer_dev->timer_event_start)
 		timer_dev->timer_event_start(next_event);
-	csr_clear(CSR_MIP, MIP_STIP);
 	csr_set(CSR_MIE, MIP_MTIP);
 }
 
+void sbi_timer_event_start(u64 next_event)
+{
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	u64 *time_next_event = sbi_scratch_offset_ptr(scratch,
+						      time_next_event_off);
+
+	sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_SET_TIMER);
+	*time_next_event = next_event;
+	timer_event_program(next_event);
+	csr_clear(CSR_MIP, MIP_STIP);
+}
+
+void sbi_timer_event_update(void)
+{
+	u64 *time_next_event;
+
+	if (!time_next_event_off)
+		return;
+
+	time_next_event = sbi_scratch_offset_ptr(sbi_scratch_thishart_ptr(),
+						 time_next_event_off);
+	timer_event_program(*time_next_event);
+}
+
 void sbi_timer_process(void)
 {
-	csr_clear(CSR_MIE, MIP_MTIP);
-	csr_set(CSR_MIP, MIP_STIP);
+	u64 *time_next_event = sbi_scratch_offset_ptr(sbi_scratch_thishart_ptr(),
+						      time_next_event_off);
+
+	sbi_pmu_mux_tick();
+
+	/* The interrupt may be only for the firmware deadline */
+	if (!get_time_val || *time_next_event <= get_time_val()) {
+		*time_next_event = -1ULL;
+		csr_set(CSR_MIP, MIP_STIP);
+	}
+
+	timer_event_program(*time_next_event);
 }
 
 const struct sbi_timer_device *sbi_timer_get_device(void)
@@ -153,7 +200,7 @@ void sbi_timer_set_device(const struct sbi_timer_device *dev)
 
 int sbi_timer_init(struct sbi_scratch *scratch, bool cold_boot)
 {
-	u64 *time_delta;
+	u64 *time_delta, *time_next_event;
 	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
 
 	if (cold_boot) {
@@ -161,16 +208,24 @@ int sbi_timer_init(struct sbi_scratch *scratch, bool cold_boot)
 		if (!time_delta_off)
 			return SBI_ENOMEM;
 
+		time_next_event_off =
+			sbi_scratch_alloc_offset(sizeof(*time_next_event));
+		if (!time_next_event_off)
+			return SBI_ENOMEM;
+
 		if (sbi_hart_has_feature(scratch, SBI_HART_HAS_TIME))
 			get_time_val = get_ticks;
 	} else {
-		if (!time_delta_off)
+		if (!time_delta_off || !time_next_event_off)
 			return SBI_ENOMEM;
 	}
 
 	time_delta = sbi_scratch_offset_ptr(scratch, time_delta_off);
 	*time_delta = 0;
 
+	time_next_event = sbi_scratch_offset_ptr(scratch, time_next_event_off);
+	*time_next_event = -1ULL;
+
 	return sbi_platform_timer_init(plat, cold_boot);
 }
 
@@ -181,6 +236,7 @@ void sbi_timer_exit(struct sbi_scratch *scratch)
 
 	csr_clear(CSR_MIP, MIP_STIP);
 	csr_clear(CSR_MIE, MIP_MTIP);
+	*(u64 *)sbi_scratch_offset_ptr(scratch, time_next_event_off) = -1ULL;
 
 	sbi_platform_timer_exit(sbi_platform_ptr(scratch));
 }
@@ -40,8 +40,6 @@ void sbi_tlb_local_hfence_vvma(struct sbi_tlb_info *tinfo)
 	unsigned long vmid  = tinfo->vmid;
 	unsigned long i, hgatp;
 
-	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_HFENCE_VVMA_RCVD);
-
 	hgatp = csr_swap(CSR_HGATP,
 			 (vmid << HGATP_VMID_SHIFT) & HGATP_VMID_MASK);
 
@@ -64,8 +62,6 @@ void sbi_tlb_local_hfence_gvma(struct sbi_tlb_info *tinfo)
 	unsigned long size  = tinfo->size;
 	unsigned long i;
 
-	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_HFENCE_GVMA_RCVD);
-
 	if ((start == 0 && size == 0) || (size == SBI_TLB_FLUSH_ALL)) {
 		__sbi_hfence_gvma_all();
 		return;
@@ -82,8 +78,6 @@ void sbi_tlb_local_sfence_vma(struct sbi_tlb_info *tinfo)
 	unsigned long size  = tinfo->size;
 	unsigned long i;
 
-	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_SFENCE_VMA_RCVD);
-
 	if ((start == 0 && size == 0) || (size == SBI_TLB_FLUSH_ALL)) {
 		tlb_flush_all();
 		return;
@@ -105,8 +99,6 @@ void sbi_tlb_local_hfence_vvma_asid(struct sbi_tlb_info *tinfo)
 	unsigned long vmid  = tinfo->vmid;
 	unsigned long i, hgatp;
 
-	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_HFENCE_VVMA_ASID_RCVD);
-
 	hgatp = csr_swap(CSR_HGATP,
 			 (vmid << HGATP_VMID_SHIFT) & HGATP_VMID_MASK);
 
@@ -135,8 +127,6 @@ void sbi_tlb_local_hfence_gvma_vmid(struct sbi_tlb_info *tinfo)
 	unsigned long vmid  = tinfo->vmid;
 	unsigned long i;
 
-	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_HFENCE_GVMA_VMID_RCVD);
-
 	if (start == 0 && size == 0) {
 		__sbi_hfence_gvma_all();
 		return;
@@ -159,8 +149,6 @@ void sbi_tlb_local_sfence_vma_asid(struct sbi_tlb_info *tinfo)
 	unsigned long asid  = tinfo->asid;
 	unsigned long i;
 
-	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_SFENCE_VMA_ASID_RCVD);
-
 	if (start == 0 && size == 0) {
 		tlb_flush_all();
 		return;
@@ -185,39 +173,61 @@ void sbi_tlb_local_sfence_vma_asid(struct sbi_tlb_info *tinfo)
 
 void sbi_tlb_local_fence_i(struct sbi_tlb_info *tinfo)
 {
-	sbi_pmu_ctr_incr_fw(SBI_PMU_FW_FENCE_I_RECVD);
-
 	__asm__ __volatile("fence.i");
 }
 
-static void tlb_pmu_incr_fw_ctr(struct sbi_tlb_info *data)
+static void tlb_pmu_incr_fw_ctr(struct sbi_scratch *scratch,
+				struct sbi_tlb_info *data)
 {
 	if (unlikely(!data))
 		return;
 
 	if (data->local_fn == sbi_tlb_local_fence_i)
-		sbi_pmu_ctr_incr_fw(SBI_PMU_FW_FENCE_I_SENT);
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_FENCE_I_SENT);
 	else if (data->local_fn == sbi_tlb_local_sfence_vma)
-		sbi_pmu_ctr_incr_fw(SBI_PMU_FW_SFENCE_VMA_SENT);
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_SFENCE_VMA_SENT);
 	else if (data->local_fn == sbi_tlb_local_sfence_vma_asid)
-		sbi_pmu_ctr_incr_fw(SBI_PMU_FW_SFENCE_VMA_ASID_SENT);
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_SFENCE_VMA_ASID_SENT);
 	else if (data->local_fn == sbi_tlb_local_hfence_gvma)
-		sbi_pmu_ctr_incr_fw(SBI_PMU_FW_HFENCE_GVMA_SENT);
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_HFENCE_GVMA_SENT);
 	else if (data->local_fn == sbi_tlb_local_hfence_gvma_vmid)
-		sbi_pmu_ctr_incr_fw(SBI_PMU_FW_HFENCE_GVMA_VMID_SENT);
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_HFENCE_GVMA_VMID_SENT);
 	else if (data->local_fn == sbi_tlb_local_hfence_vvma)
-		sbi_pmu_ctr_incr_fw(SBI_PMU_FW_HFENCE_VVMA_SENT);
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_HFENCE_VVMA_SENT);
 	else if (data->local_fn == sbi_tlb_local_hfence_vvma_asid)
-		sbi_pmu_ctr_incr_fw(SBI_PMU_FW_HFENCE_VVMA_ASID_SENT);
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_HFENCE_VVMA_ASID_SENT);
 }
 
-static void tlb_entry_process(struct sbi_tlb_info *tinfo)
+/* Count and do a flush request on the current HART */
+static void tlb_local_flush(struct sbi_scratch *scratch,
+			    struct sbi_tlb_info *tinfo)
+{
+	if (tinfo->local_fn == sbi_tlb_local_fence_i)
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_FENCE_I_RECVD);
+	else if (tinfo->local_fn == sbi_tlb_local_sfence_vma)
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_SFENCE_VMA_RCVD);
+	else if (tinfo->local_fn == sbi_tlb_local_sfence_vma_asid)
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_SFENCE_VMA_ASID_RCVD);
+	else if (tinfo->local_fn == sbi_tlb_local_hfence_gvma)
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_HFENCE_GVMA_RCVD);
+	else if (tinfo->local_fn == sbi_tlb_local_hfence_gvma_vmid)
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_HFENCE_GVMA_VMID_RCVD);
+	else if (tinfo->local_fn == sbi_tlb_local_hfence_vvma)
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_HFENCE_VVMA_RCVD);
+	else if (tinfo->local_fn == sbi_tlb_local_hfence_vvma_asid)
+		sbi_pmu_ctr_incr_fw(scratch, SBI_PMU_FW_HFENCE_VVMA_ASID_RCVD);
+
+	tinfo->local_fn(tinfo);
+}
+
+static void tlb_entry_process(struct sbi_scratch *scratch,
+			      struct sbi_tlb_info *tinfo)
 {
 	u32 rhartid;
 	struct sbi_scratch *rscratch = NULL;
 	unsigned long *rtlb_sync = NULL;
 
-	tinfo->local_fn(tinfo);
+	tlb_local_flush(scratch, tinfo);
 
 	sbi_hartmask_for_each_hart(rhartid, &tinfo->smask) {
 		rscratch = sbi_hartid_to_scratch(rhartid);
@@ -237,7 +247,7 @@ static void tlb_process_count(struct sbi_scratch *scratch, int count)
 			sbi_scratch_offset_ptr(scratch, tlb_fifo_off);
 
 	while (!sbi_fifo_dequeue(tlb_fifo, &tinfo)) {
-		tlb_entry_process(&tinfo);
+		tlb_entry_process(scratch, &tinfo);
 		deq_count++;
 		if (deq_count > count)
 			break;
@@ -252,7 +262,7 @@ static void tlb_process(struct sbi_scratch *scratch)
 			sbi_scratch_offset_ptr(scratch, tlb_fifo_off);
 
 	while (!sbi_fifo_dequeue(tlb_fifo, &tinfo))
-		tlb_entry_process(&tinfo);
+		tlb_entry_process(scratch, &tinfo);
 }
 
 static void tlb_sync(struct sbi_scratch *scratch)
@@ -345,7 +355,7 @@ static int tlb_update(struct sbi_scratch *scratch,
 	int ret;
 	struct sbi_fifo *tlb_fifo_r;
 	struct sbi_tlb_info *tinfo = data;
-	u32 curr_hartid = current_hartid();
+	u32 curr_hartid = scratch->hartid;
 
 	/*
 	 * If address range to flush is too big then simply
@@ -362,7 +372,7 @@ static int tlb_update(struct sbi_scratch *scratch,
 	 * then just do a local flush and return;
 	 */
 	if (remote_hartid == curr_hartid) {
-		tinfo->local_fn(tinfo);
+		tlb_local_flush(scratch, tinfo);
 		return -1;
 	}
 
@@ -404,7 +414,7 @@ int sbi_tlb_request(ulong hmask, ulong hbase, struct sbi_tlb_info *tinfo)
 	if (!tinfo->local_fn)
 		return SBI_EINVAL;
 
-	tlb_pmu_incr_fw_ctr(tinfo);
+	tlb_pmu_incr_fw_ctr(sbi_scratch_thishart_ptr(), tinfo);
 
 	return sbi_ipi_send_many(hmask, hbase, tlb_event, tinfo);
 }
@@ -418,16 +428,26 @@ int sbi_tlb_init(struct sbi_scratch *scratch, bool cold_boot)
 	const struct sbi_platform *plat = sbi_platform_ptr(scratch);
 
 	if (cold_boot) {
-		tlb_sync_off = sbi_scratch_alloc_offset(sizeof(*tlb_sync));
+		/*
+		 * The sync flag, the FIFO header (with its lock) and the
+		 * FIFO entries are all written by remote HARTs so each of
+		 * them gets its own cache lines.
+		 */
+		tlb_sync_off = sbi_scratch_alloc_aligned_offset(
+					sizeof(*tlb_sync),
+					SBI_SCRATCH_CACHELINE_SIZE);
 		if (!tlb_sync_off)
 			return SBI_ENOMEM;
-		tlb_fifo_off = sbi_scratch_alloc_offset(sizeof(*tlb_q));
+		tlb_fifo_off = sbi_scratch_alloc_aligned_offset(
+					sizeof(*tlb_q),
+					SBI_SCRATCH_CACHELINE_SIZE);
 		if (!tlb_fifo_off) {
 			sbi_scratch_free_offset(tlb_sync_off);
 			return SBI_ENOMEM;
 		}
-		tlb_fifo_mem_off = sbi_scratch_alloc_offset(
-				SBI_TLB_FIFO_NUM_ENTRIES * SBI_TLB_INFO_SIZE);
+		tlb_fifo_mem_off = sbi_scratch_alloc_aligned_offset(
+				SBI_TLB_FIFO_NUM_ENTRIES * SBI_TLB_INFO_SIZE,
+				SBI_SCRATCH_CACHELINE_SIZE);
 		if (!tlb_fifo_mem_off) {
 			sbi_scratch_free_offset(tlb_fifo_off);
 			sbi_scratch_free_offset(tlb_sync_off);
@@ -0,0 +1,177 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2021 Renesas Electronics Corporation
+ */
+
+#include <sbi/riscv_asm.h>
+#include <sbi/riscv_io.h>
+#include <sbi/sbi_error.h>
+#include <sbi_utils/cache/andes_l2c.h>
+
+#define L2C_REG_CTL_OFFSET		0x08
+#define L2C_REG_HPM_OFFSET(n)		(0x10 + ((n) * 0x8))
+#define L2C_REG_CMD_OFFSET(core)	(0x40 + ((core) * 0x10))
+#define L2C_REG_ACC_OFFSET(core)	(0x48 + ((core) * 0x10))
+#define L2C_REG_STATUS_OFFSET		0x80
+
+/* Each core has a 4-bit CCTL status field, zero when idle */
+#define L2C_STATUS_CORE_MASK(core)	(0xfU << ((core) * 4))
+
+#define L2C_CCTL_PA_INVAL		0x08
+#define L2C_CCTL_PA_WB			0x09
+#define L2C_CCTL_PA_WBINVAL		0x0a
+#define L2C_CCTL_WBINVAL_ALL		0x12
+
+/* Only CCTL status fields for cores 0-7 fit in the status register */
+#define L2C_CCTL_CORE_MAX		8
+
+static struct andes_l2c_data *l2c;
+
+static inline volatile void *l2c_reg(unsigned long offset)
+{
+	return (volatile void *)(l2c->addr + offset);
+}
+
+static void l2c_cctl(u32 core, u32 cmd)
+{
+	writel(cmd, l2c_reg(L2C_REG_CMD_OFFSET(core)));
+	while (readl(l2c_reg(L2C_REG_STATUS_OFFSET)) &
+	       L2C_STATUS_CORE_MASK(core))
+		;
+}
+
+static void l2c_range_op(unsigned long start, unsigned long end, u32 cmd)
+{
+	u32 core = current_hartid();
+
+	for (; start < end; start += l2c->line_size) {
+#if __riscv_xlen != 32
+		writeq(start, l2c_reg(L2C_REG_ACC_OFFSET(core)));
+#else
+		writel(start, l2c_reg(L2C_REG_ACC_OFFSET(core)));
+#endif
+		l2c_cctl(core, cmd);
+	}
+}
+
+/*
+ * Range operations beyond the cache size fall back to a whole cache
+ * write back and invalidate, which is always a correct superset.
+ */
+static bool l2c_range_too_big(unsigned long size)
+{
+	if (!l2c->size || size <= l2c->size)
+		return FALSE;
+
+	l2c_cctl(current_hartid(), L2C_CCTL_WBINVAL_ALL);
+	return TRUE;
+}
+
+bool andes_l2c_available(void)
+{
+	return (l2c && current_hartid() < L2C_CCTL_CORE_MAX) ? TRUE : FALSE;
+}
+
+void andes_l2c_wb_range(unsigned long addr, unsigned long size)
+{
+	if (!size || !andes_l2c_available() || l2c_range_too_big(size))
+		return;
+
+	l2c_range_op(addr & ~(l2c->line_size - 1UL), addr + size,
+		     L2C_CCTL_PA_WB);
+}
+
+void andes_l2c_inval_range(unsigned long addr, unsigned long size)
+{
+	unsigned long start, end, mask;
+
+	if (!size || !andes_l2c_available() || l2c_range_too_big(size))
+		return;
+
+	mask = l2c->line_size - 1UL;
+	start = addr & ~mask;
+	end = (addr + size + mask) & ~mask;
+
+	/* Partial lines at the edges may hold other data, so write them back */
+	if (start != addr) {
+		l2c_range_op(start, start + l2c->line_size,
+			     L2C_CCTL_PA_WBINVAL);
+		start += l2c->line_size;
+	}
+	if (end != addr + size && start < end) {
+		l2c_range_op(end - l2c->line_size, end, L2C_CCTL_PA_WBINVAL);
+		end -= l2c->line_size;
+	}
+	l2c_range_op(start, end, L2C_CCTL_PA_INVAL);
+}
+
+void andes_l2c_wbinval_range(unsigned long addr, unsigned long size)
+{
+	if (!size || !andes_l2c_available() || l2c_range_too_big(size))
+		return;
+
+	l2c_range_op(addr & ~(l2c->line_size - 1UL), addr + size,
+		     L2C_CCTL_PA_WBINVAL);
+}
+
+int andes_l2c_set_prefetch(u32 inst_depth, u32 data_depth)
+{
+	u32 ctl;
+
+	if (!l2c)
+		return SBI_ENODEV;
+	if (inst_depth > 3 || data_depth > 3)
+		return SBI_EINVAL;
+
+	ctl = readl(l2c_reg(L2C_REG_CTL_OFFSET));
+	ctl &= ~(ANDES_L2C_CTL_IPFDPT_MASK | ANDES_L2C_CTL_DPFDPT_MASK);
+	ctl |= inst_depth << ANDES_L2C_CTL_IPFDPT_OFFSET;
+	ctl |= data_depth << ANDES_L2C_CTL_DPFDPT_OFFSET;
+	writel(ctl, l2c_reg(L2C_REG_CTL_OFFSET));
+
+	return 0;
+}
+
+int andes_l2c_hpm_read(u32 idx, u64 *out_val)
+{
+#if __riscv_xlen == 32
+	u32 lo, hi;
+#endif
+
+	if (!l2c || !l2c->has_hpm)
+		return SBI_ENOTSUPP;
+	if (idx >= ANDES_L2C_HPM_COUNT)
+		return SBI_EINVAL;
+
+#if __riscv_xlen != 32
+	*out_val = readq(l2c_reg(L2C_REG_HPM_OFFSET(idx)));
+#else
+	do {
+		hi = readl(l2c_reg(L2C_REG_HPM_OFFSET(idx) + 4));
+		lo = readl(l2c_reg(L2C_REG_HPM_OFFSET(idx)));
+	} while (hi != readl(l2c_reg(L2C_REG_HPM_OFFSET(idx) + 4)));
+	*out_val = ((u64)hi << 32) | lo;
+#endif
+
+	return 0;
+}
+
+int andes_l2c_init(struct andes_l2c_data *data)
+{
+	u32 ctl;
+
+	if (!data || !data->addr)
+		return SBI_EINVAL;
+	if (!data->line_size || (data->line_size & (data->line_size - 1)))
+		return SBI_EINVAL;
+
+	l2c = data;
+
+	ctl = readl(l2c_reg(L2C_REG_CTL_OFFSET));
+	ctl &= ~l2c->ctl_mask;
+	ctl |= (l2c->ctl_val & l2c->ctl_mask) | ANDES_L2C_CTL_ENABLE_MASK;
+	writel(ctl, l2c_reg(L2C_REG_CTL_OFFSET));
+
+	return 0;
+}
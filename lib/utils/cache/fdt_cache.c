@@ -0,0 +1,50 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2021 Renesas Electronics Corporation
+ */
+
+#include <sbi/sbi_console.h>
+#include <sbi/sbi_error.h>
+#include <sbi/sbi_scratch.h>
+#include <sbi_utils/cache/fdt_cache.h>
+#include <sbi_utils/fdt/fdt_helper.h>
+
+extern struct fdt_cache fdt_cache_andes_l2c;
+
+static struct fdt_cache *cache_drivers[] = {
+	&fdt_cache_andes_l2c,
+};
+
+int fdt_cache_driver_init(void *fdt, struct fdt_cache *drv)
+{
+	int noff, rc = SBI_ENODEV;
+	const struct fdt_match *match;
+
+	noff = fdt_find_match(fdt, -1, drv->match_table, &match);
+	if (noff < 0)
+		return SBI_ENODEV;
+
+	if (drv->init) {
+		rc = drv->init(fdt, noff, match);
+		if (rc && rc != SBI_ENODEV) {
+			sbi_printf("%s: %s init failed, %d\n",
+				   __func__, match->compatible, rc);
+		}
+	}
+
+	return rc;
+}
+
+int fdt_cache_init(void)
+{
+	int pos, rc = SBI_ENODEV;
+	void *fdt = fdt_get_address();
+
+	for (pos = 0; pos < array_size(cache_drivers); pos++) {
+		if (!fdt_cache_driver_init(fdt, cache_drivers[pos]))
+			rc = 0;
+	}
+
+	return rc;
+}
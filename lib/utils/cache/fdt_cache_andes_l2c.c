@@ -0,0 +1,82 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Copyright (c) 2021 Renesas Electronics Corporation
+ */
+
+#include <libfdt.h>
+#include <sbi/sbi_error.h>
+#include <sbi_utils/cache/andes_l2c.h>
+#include <sbi_utils/cache/fdt_cache.h>
+#include <sbi_utils/fdt/fdt_helper.h>
+
+#define ANDES_L2C_DEFAULT_LINE_SIZE	64
+
+static struct andes_l2c_data l2c;
+
+static void andes_l2c_parse_field(void *fdt, int nodeoff, const char *prop,
+				  int index, u32 max, u32 offset)
+{
+	const fdt32_t *val;
+	int len;
+
+	val = fdt_getprop(fdt, nodeoff, prop, &len);
+	if (!val || len < (int)((index + 1) * sizeof(fdt32_t)))
+		return;
+	if (fdt32_to_cpu(val[index]) > max)
+		return;
+
+	l2c.ctl_mask |= max << offset;
+	l2c.ctl_val |= fdt32_to_cpu(val[index]) << offset;
+}
+
+static int cache_andes_l2c_init(void *fdt, int nodeoff,
+				const struct fdt_match *match)
+{
+	const fdt32_t *val;
+	uint64_t addr;
+	int len, rc;
+
+	rc = fdt_get_node_addr_size(fdt, nodeoff, 0, &addr, NULL);
+	if (rc < 0 || !addr)
+		return SBI_ENODEV;
+
+	l2c.addr = (unsigned long)addr;
+
+	val = fdt_getprop(fdt, nodeoff, "cache-size", &len);
+	l2c.size = (val && len >= sizeof(fdt32_t)) ? fdt32_to_cpu(*val) : 0;
+
+	val = fdt_getprop(fdt, nodeoff, "cache-line-size", &len);
+	l2c.line_size = (val && len >= sizeof(fdt32_t)) ?
+			fdt32_to_cpu(*val) : ANDES_L2C_DEFAULT_LINE_SIZE;
+
+	/* Fields without a property keep their reset value */
+	andes_l2c_parse_field(fdt, nodeoff, "andes,inst-prefetch", 0, 3,
+			      ANDES_L2C_CTL_IPFDPT_OFFSET);
+	andes_l2c_parse_field(fdt, nodeoff, "andes,data-prefetch", 0, 3,
+			      ANDES_L2C_CTL_DPFDPT_OFFSET);
+	andes_l2c_parse_field(fdt, nodeoff, "andes,tag-ram-ctl", 0, 3,
+			      ANDES_L2C_CTL_TRAMOCTL_OFFSET);
+	andes_l2c_parse_field(fdt, nodeoff, "andes,tag-ram-ctl", 1, 1,
+			      ANDES_L2C_CTL_TRAMICTL_OFFSET);
+	andes_l2c_parse_field(fdt, nodeoff, "andes,data-ram-ctl", 0, 3,
+			      ANDES_L2C_CTL_DRAMOCTL_OFFSET);
+	andes_l2c_parse_field(fdt, nodeoff, "andes,data-ram-ctl", 1, 1,
+			      ANDES_L2C_CTL_DRAMICTL_OFFSET);
+
+	l2c.has_hpm = fdt_getprop(fdt, nodeoff, "andes,perf-monitor",
+				  NULL) ? TRUE : FALSE;
+
+	return andes_l2c_init(&l2c);
+}
+
+static const struct fdt_match cache_andes_l2c_match[] = {
+	{ .compatible = "andestech,ax45mp-cache" },
+	{ .compatible = "andestech,l2c" },
+	{ },
+};
+
+struct fdt_cache fdt_cache_andes_l2c = {
+	.match_table = cache_andes_l2c_match,
+	.init = cache_andes_l2c_init,
+};
@@ -0,0 +1,9 @@
+#
+# SPDX-License-Identifier: BSD-2-Clause
+#
+# Copyright (c) 2021 Renesas Electronics Corporation
+#
+
+libsbiutils-objs-y += cache/andes_l2c.o
+libsbiutils-objs-y += cache/fdt_cache.o
+libsbiutils-objs-y += cache/fdt_cache_andes_l2c.o
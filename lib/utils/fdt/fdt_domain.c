@@ -15,6 +15,7 @@
 #include <sbi/sbi_hartmask.h>
 #include <sbi/sbi_scratch.h>
 #include <sbi_utils/fdt/fdt_domain.h>
+#include <sbi_utils/fdt/fdt_edit.h>
 #include <sbi_utils/fdt/fdt_helper.h>
 
 int fdt_iterate_each_domain(void *fdt, void *opaque,
@@ -29,7 +30,7 @@ int fdt_iterate_each_domain(void *fdt, void *opaque,
 	poffset = fdt_path_offset(fdt, "/chosen");
 	if (poffset < 0)
 		return 0;
-	poffset = fdt_node_offset_by_compatible(fdt, poffset,
+	poffset = fdt_index_node_by_compatible(fdt, poffset,
 						"opensbi,domain,config");
 	if (poffset < 0)
 		return 0;
@@ -69,7 +70,7 @@ int fdt_iterate_each_memregion(void *fdt, int domain_offset, void *opaque,
 
 	rcount = (u32)len / (sizeof(u32) * 2);
 	for (i = 0; i < rcount; i++) {
-		region_offset = fdt_node_offset_by_phandle(fdt,
+		region_offset = fdt_index_node_by_phandle(fdt,
 						fdt32_to_cpu(regions[2 * i]));
 		if (region_offset < 0)
 			return region_offset;
@@ -125,7 +126,7 @@ static int __fixup_count_disable_devices(void *fdt, int doff, int roff,
 static int __fixup_disable_devices(void *fdt, int doff, int roff,
 				   u32 raccess, void *p)
 {
-	int i, len, coff;
+	int i, len, coff, err;
 	const u32 *devices;
 
 	if (raccess & DISABLE_DEVICES_MASK)
@@ -138,82 +139,136 @@ static int __fixup_disable_devices(void *fdt, int doff, int roff,
 	len = len / sizeof(u32);
 
 	for (i = 0; i < len; i++) {
-		coff = fdt_node_offset_by_phandle(fdt,
+		coff = fdt_index_node_by_phandle(fdt,
 					fdt32_to_cpu(devices[i]));
 		if (coff < 0)
 			return coff;
 
-		fdt_setprop_string(fdt, coff, "status", "disabled");
+		err = fdt_edit_disable_node(fdt, coff);
+		if (err < 0)
+			return err;
 	}
 
 	return 0;
 }
 
-void fdt_domain_fixup(void *fdt)
+static int __fixup_find_domain(void *fdt, struct sbi_domain *dom,
+			       int *doffset)
 {
-	u32 i, dcount;
-	int err, poffset, doffset;
-	struct sbi_domain *dom = sbi_domain_thishart_ptr();
 	struct __fixup_find_domain_offset_info fdo;
 
-	/* Remove the domain assignment DT property from CPU DT nodes */
+	*doffset = -1;
+	fdo.name = dom->name;
+	fdo.doffset = doffset;
+
+	return fdt_iterate_each_domain(fdt, &fdo, __fixup_find_domain_offset);
+}
+
+static int __fixup_domain_cpus(void *fdt, void *priv)
+{
+	int err, poffset, doffset;
+	u32 hartid;
+
 	poffset = fdt_path_offset(fdt, "/cpus");
 	if (poffset < 0)
-		return;
+		return 0;
+
 	fdt_for_each_subnode(doffset, fdt, poffset) {
-		err = fdt_parse_hart_id(fdt, doffset, &i);
+		err = fdt_parse_hart_id(fdt, doffset, &hartid);
 		if (err)
 			continue;
+		if (!fdt_getprop(fdt, doffset, "opensbi-domain", NULL))
+			continue;
 
-		fdt_nop_property(fdt, doffset, "opensbi-domain");
+		err = fdt_edit_nop_property(fdt, doffset, "opensbi-domain");
+		if (err < 0)
+			return err;
 	}
 
+	return 0;
+}
+
+static int __fixup_domain_devices(void *fdt, void *priv)
+{
+	int err, doffset;
+
+	err = __fixup_find_domain(fdt, priv, &doffset);
+	if (err || doffset < 0)
+		return err;
+
+	return fdt_iterate_each_memregion(fdt, doffset, NULL,
+					  __fixup_disable_devices);
+}
+
+static int __fixup_domain_config(void *fdt, void *priv)
+{
+	int poffset;
+
+	poffset = fdt_path_offset(fdt, "/chosen");
+	if (poffset < 0)
+		return 0;
+	poffset = fdt_index_node_by_compatible(fdt, poffset,
+						"opensbi,domain,config");
+	if (poffset < 0)
+		return 0;
+
+	return fdt_edit_nop_node(fdt, poffset);
+}
+
+int fdt_domain_fixup(void *fdt)
+{
+	u32 dcount;
+	int err, doffset;
+	struct sbi_domain *dom = sbi_domain_thishart_ptr();
+
+	/* Remove the domain assignment DT property from CPU DT nodes */
+	if (fdt_path_offset(fdt, "/cpus") < 0)
+		return 0;
+	err = fdt_edit_run(fdt, __fixup_domain_cpus, NULL);
+	if (err)
+		return err;
+
 	/* Skip device disable for root domain */
 	if (!dom->index)
 		goto skip_device_disable;
 
 	/* Find current domain DT node */
-	doffset = -1;
-	fdo.name = dom->name;
-	fdo.doffset = &doffset;
-	fdt_iterate_each_domain(fdt, &fdo, __fixup_find_domain_offset);
+	err = __fixup_find_domain(fdt, dom, &doffset);
+	if (err)
+		return err;
 	if (doffset < 0)
 		goto skip_device_disable;
 
 	/* Count current domain device DT nodes to be disabled */
 	dcount = 0;
-	fdt_iterate_each_memregion(fdt, doffset, &dcount,
-				   __fixup_count_disable_devices);
+	err = fdt_iterate_each_memregion(fdt, doffset, &dcount,
+					 __fixup_count_disable_devices);
+	if (err)
+		return err;
 	if (!dcount)
 		goto skip_device_disable;
 
-	/* Expand FDT based on device DT nodes to be disabled */
-	err = fdt_open_into(fdt, fdt, fdt_totalsize(fdt) + dcount * 32);
-	if (err < 0)
-		return;
-
-	/* Again find current domain DT node */
-	doffset = -1;
-	fdo.name = dom->name;
-	fdo.doffset = &doffset;
-	fdt_iterate_each_domain(fdt, &fdo, __fixup_find_domain_offset);
-	if (doffset < 0)
-		goto skip_device_disable;
+	/*
+	 * Expand FDT based on device DT nodes to be disabled unless
+	 * an edit session queues the edits and grows the FDT later.
+	 */
+	if (!fdt_edit_active(fdt)) {
+		err = fdt_open_into(fdt, fdt, fdt_totalsize(fdt) + dcount * 32);
+		if (err < 0)
+			return err;
+	}
 
-	/* Disable device DT nodes for current domain */
-	fdt_iterate_each_memregion(fdt, doffset, NULL,
-				   __fixup_disable_devices);
+	/*
+	 * Disable device DT nodes for current domain. The pass looks up
+	 * the domain DT node again because node offsets may have moved.
+	 */
+	err = fdt_edit_run(fdt, __fixup_domain_devices, dom);
+	if (err)
+		return err;
 skip_device_disable:
 
 	/* Remove the OpenSBI domain config DT node */
-	poffset = fdt_path_offset(fdt, "/chosen");
-	if (poffset < 0)
-		return;
-	poffset = fdt_node_offset_by_compatible(fdt, poffset,
-						"opensbi,domain,config");
-	if (poffset < 0)
-		return;
-	fdt_nop_node(fdt, poffset);
+	return fdt_edit_run(fdt, __fixup_domain_config, NULL);
 }
 
 #define FDT_DOMAIN_MAX_COUNT		8
@@ -299,7 +354,7 @@ static int __fdt_parse_domain(void *fdt, int domain_offset, void *opaque)
 	len = len / sizeof(u32);
 	if (val && len) {
 		for (i = 0; i < len; i++) {
-			cpu_offset = fdt_node_offset_by_phandle(fdt,
+			cpu_offset = fdt_index_node_by_phandle(fdt,
 							fdt32_to_cpu(val[i]));
 			if (cpu_offset < 0)
 				return cpu_offset;
@@ -345,7 +400,7 @@ static int __fdt_parse_domain(void *fdt, int domain_offset, void *opaque)
 	val32 = -1U;
 	val = fdt_getprop(fdt, domain_offset, "boot-hart", &len);
 	if (val && len >= 4) {
-		cpu_offset = fdt_node_offset_by_phandle(fdt,
+		cpu_offset = fdt_index_node_by_phandle(fdt,
 							 fdt32_to_cpu(*val));
 		if (cpu_offset >= 0)
 			fdt_parse_hart_id(fdt, cpu_offset, &val32);
@@ -418,7 +473,7 @@ static int __fdt_parse_domain(void *fdt, int domain_offset, void *opaque)
 		if (!val || len < 4)
 			return SBI_EINVAL;
 
-		doffset = fdt_node_offset_by_phandle(fdt, fdt32_to_cpu(*val));
+		doffset = fdt_index_node_by_phandle(fdt, fdt32_to_cpu(*val));
 		if (doffset < 0)
 			return doffset;
 
@@ -462,7 +517,7 @@ int fdt_domains_populate(void *fdt)
 
 		val = fdt_getprop(fdt, cpu_offset, "opensbi-domain", &len);
 		if (val && len >= 4)
-			cold_domain_offset = fdt_node_offset_by_phandle(fdt,
+			cold_domain_offset = fdt_index_node_by_phandle(fdt,
 							   fdt32_to_cpu(*val));
 
 		break;
@@ -0,0 +1,517 @@
+// SPDX-License-Identifier: BSD-2-Clause
+/*
+ * fdt_edit.c - Batched Flat Device Tree edit session
+ *
+ * Each libfdt read-write call splices the structure block and moves
+ * everything behind the edit point. A session queues the edits instead
+ * and applies them while copying the structure block once.
+ *
+ * Copyright (c) 2021 Renesas Electronics Corporation
+ */
+
+#include <libfdt.h>
+#include <sbi/sbi_string.h>
+#include <sbi_utils/fdt/fdt_edit.h>
+#include <sbi_utils/fdt/fdt_helper.h>
+
+#ifndef FDT_EDIT_MAX_OPS
+#define FDT_EDIT_MAX_OPS		128
+#endif
+
+#ifndef FDT_EDIT_VALUE_POOL_SIZE
+#define FDT_EDIT_VALUE_POOL_SIZE	2048
+#endif
+
+#define FDT_EDIT_TAGALIGN(x)	(((x) + FDT_TAGSIZE - 1) & ~(FDT_TAGSIZE - 1))
+
+enum fdt_edit_op_type {
+	FDT_EDIT_SETPROP = 0,
+	FDT_EDIT_NOP_PROPERTY,
+	FDT_EDIT_NOP_NODE,
+};
+
+struct fdt_edit_op {
+	int nodeoff;
+	enum fdt_edit_op_type type;
+	const char *name;
+	u32 val_off;
+	int len;
+	int nameoff;
+	bool applied;
+};
+
+static struct {
+	void *fdt;
+	u32 op_count;
+	u32 pool_used;
+	struct fdt_edit_op ops[FDT_EDIT_MAX_OPS];
+	char pool[FDT_EDIT_VALUE_POOL_SIZE];
+} fdt_edit;
+
+bool fdt_edit_active(void *fdt)
+{
+	return fdt && fdt_edit.fdt == fdt;
+}
+
+int fdt_edit_begin(void *fdt)
+{
+	int err;
+
+	if (!fdt)
+		return -FDT_ERR_BADVALUE;
+	if (fdt_edit.fdt)
+		return -FDT_ERR_BADSTATE;
+
+	err = fdt_check_header(fdt);
+	if (err)
+		return err;
+
+	/* Make sure the blocks are in the order expected by the rewrite */
+	err = fdt_open_into(fdt, fdt, fdt_totalsize(fdt));
+	fdt_index_invalidate();
+	if (err)
+		return err;
+
+	fdt_edit.fdt = fdt;
+	fdt_edit.op_count = 0;
+	fdt_edit.pool_used = 0;
+
+	return 0;
+}
+
+static struct fdt_edit_op *fdt_edit_find_op(int nodeoff, const char *name)
+{
+	u32 i;
+	struct fdt_edit_op *op;
+
+	for (i = 0; i < fdt_edit.op_count; i++) {
+		op = &fdt_edit.ops[i];
+		if (op->nodeoff == nodeoff && op->type != FDT_EDIT_NOP_NODE &&
+		    !sbi_strcmp(op->name, name))
+			return op;
+	}
+
+	return NULL;
+}
+
+static int fdt_edit_queue(int nodeoff, enum fdt_edit_op_type type,
+			  const char *name, const void *val, int len)
+{
+	struct fdt_edit_op *op = NULL;
+
+	if (fdt_get_name(fdt_edit.fdt, nodeoff, NULL) == NULL)
+		return -FDT_ERR_BADOFFSET;
+
+	if (type == FDT_EDIT_SETPROP) {
+		if (len < 0 || (!val && len))
+			return -FDT_ERR_BADVALUE;
+		if ((FDT_EDIT_VALUE_POOL_SIZE - fdt_edit.pool_used) < len)
+			return -FDT_ERR_NOSPACE;
+	}
+
+	/* Later edits of the same property replace earlier ones */
+	if (type != FDT_EDIT_NOP_NODE)
+		op = fdt_edit_find_op(nodeoff, name);
+	if (!op) {
+		if (fdt_edit.op_count == FDT_EDIT_MAX_OPS)
+			return -FDT_ERR_NOSPACE;
+		op = &fdt_edit.ops[fdt_edit.op_count++];
+	}
+
+	if (type == FDT_EDIT_SETPROP) {
+		sbi_memcpy(&fdt_edit.pool[fdt_edit.pool_used], val, len);
+		op->val_off = fdt_edit.pool_used;
+		fdt_edit.pool_used += len;
+	}
+
+	op->nodeoff = nodeoff;
+	op->type = type;
+	op->name = name;
+	op->len = (type == FDT_EDIT_SETPROP) ? len : 0;
+	op->nameoff = -1;
+	op->applied = false;
+
+	return 0;
+}
+
+int fdt_edit_setprop(void *fdt, int nodeoff, const char *name,
+		     const void *val, int len)
+{
+	int err;
+
+	if (!fdt_edit_active(fdt)) {
+		err = fdt_setprop(fdt, nodeoff, name, val, len);
+		fdt_index_invalidate();
+		return err;
+	}
+
+	return fdt_edit_queue(nodeoff, FDT_EDIT_SETPROP, name, val, len);
+}
+
+int fdt_edit_disable_node(void *fdt, int nodeoff)
+{
+	const char *status;
+	int len;
+
+	status = fdt_getprop(fdt, nodeoff, "status", &len);
+	if (status && len == sizeof("disabled") &&
+	    !sbi_memcmp(status, "disabled", len))
+		return 0;
+
+	return fdt_edit_setprop(fdt, nodeoff, "status", "disabled",
+				sizeof("disabled"));
+}
+
+int fdt_edit_nop_property(void *fdt, int nodeoff, const char *name)
+{
+	int err;
+
+	if (!fdt_edit_active(fdt)) {
+		err = fdt_nop_property(fdt, nodeoff, name);
+		fdt_index_invalidate();
+		return err;
+	}
+
+	return fdt_edit_queue(nodeoff, FDT_EDIT_NOP_PROPERTY, name, NULL, 0);
+}
+
+int fdt_edit_nop_node(void *fdt, int nodeoff)
+{
+	int err;
+
+	if (!fdt_edit_active(fdt)) {
+		err = fdt_nop_node(fdt, nodeoff);
+		fdt_index_invalidate();
+		return err;
+	}
+
+	return fdt_edit_queue(nodeoff, FDT_EDIT_NOP_NODE, NULL, NULL, 0);
+}
+
+static int fdt_edit_find_string(const char *strtab, int strsize,
+				const char *name)
+{
+	int off = 0, len, namelen = sbi_strlen(name);
+
+	while (off < strsize) {
+		len = sbi_strnlen(&strtab[off], strsize - off);
+		if (len == namelen && !sbi_memcmp(&strtab[off], name, len))
+			return off;
+		off += len + 1;
+	}
+
+	return -1;
+}
+
+/*
+ * Sort queued edits by node offset keeping the queue order for edits
+ * of the same node. The queue is small so insertion sort is enough.
+ */
+static void fdt_edit_sort_ops(void)
+{
+	u32 i, j;
+	struct fdt_edit_op tmp;
+
+	for (i = 1; i < fdt_edit.op_count; i++) {
+		tmp = fdt_edit.ops[i];
+		for (j = i; j > 0 && fdt_edit.ops[j - 1].nodeoff > tmp.nodeoff;
+		     j--)
+			fdt_edit.ops[j] = fdt_edit.ops[j - 1];
+		fdt_edit.ops[j] = tmp;
+	}
+}
+
+static char *fdt_edit_emit_prop(char *out, int nameoff,
+				const void *val, int len)
+{
+	struct fdt_property *prop = (struct fdt_property *)out;
+
+	prop->tag = cpu_to_fdt32(FDT_PROP);
+	prop->len = cpu_to_fdt32(len);
+	prop->nameoff = cpu_to_fdt32(nameoff);
+	sbi_memmove(prop->data, val, len);
+	out += sizeof(*prop) + len;
+	while ((unsigned long)(out - (char *)prop) & (FDT_TAGSIZE - 1))
+		*out++ = 0;
+
+	return out;
+}
+
+static char *fdt_edit_emit_pending(char *out, u32 first, u32 last)
+{
+	u32 i;
+	struct fdt_edit_op *op;
+
+	for (i = first; i < last; i++) {
+		op = &fdt_edit.ops[i];
+		if (op->type != FDT_EDIT_SETPROP || op->applied)
+			continue;
+		out = fdt_edit_emit_prop(out, op->nameoff,
+					 &fdt_edit.pool[op->val_off], op->len);
+		op->applied = true;
+	}
+
+	return out;
+}
+
+/*
+ * Walk the structure block once before it is rewritten. The rewrite
+ * overwrites the part it has already read, so it must not fail half way
+ * and leave the device tree broken.
+ */
+static int fdt_edit_check_struct(void *fdt)
+{
+	const struct fdt_property *prop;
+	int off = 0, next;
+	u32 tag;
+
+	do {
+		tag = fdt_next_tag(fdt, off, &next);
+		if (next < 0)
+			return next;
+		if (tag == FDT_PROP) {
+			prop = fdt_offset_ptr(fdt, off, sizeof(*prop));
+			if (!prop ||
+			    !fdt_string(fdt, fdt32_to_cpu(prop->nameoff)))
+				return -FDT_ERR_BADSTRUCTURE;
+		}
+		off = next;
+	} while (tag != FDT_END);
+
+	return 0;
+}
+
+static int fdt_edit_apply(void *fdt)
+{
+	char *base = fdt, *out, *strtab;
+	const struct fdt_property *prop;
+	const char *name;
+	struct fdt_edit_op *op;
+	int err, off, next, depth, nameoff, len;
+	int struct_off, struct_size, strings_size, in_off, grow, extra;
+	u32 i, tag, k, first, last;
+	bool skip;
+
+	if (!fdt_edit.op_count)
+		return 0;
+
+	/*
+	 * The blob is rewritten below, including same-length in-place
+	 * edits which the FDT index can not detect on its own.
+	 */
+	fdt_index_invalidate();
+
+	err = fdt_edit_check_struct(fdt);
+	if (err)
+		return err;
+
+	struct_off = fdt_off_dt_struct(fdt);
+	struct_size = fdt_size_dt_struct(fdt);
+	strings_size = fdt_size_dt_strings(fdt);
+	strtab = base + fdt_off_dt_strings(fdt);
+
+	/* Resolve property names and worst case growth of both blocks */
+	grow = extra = 0;
+	for (k = 0; k < fdt_edit.op_count; k++) {
+		op = &fdt_edit.ops[k];
+		if (op->type != FDT_EDIT_SETPROP)
+			continue;
+
+		grow += FDT_EDIT_TAGALIGN(sizeof(*prop) + op->len);
+		op->nameoff = fdt_edit_find_string(strtab, strings_size,
+						   op->name);
+		if (op->nameoff >= 0)
+			continue;
+
+		for (i = 0; i < k; i++) {
+			if (fdt_edit.ops[i].type == FDT_EDIT_SETPROP &&
+			    strings_size <= fdt_edit.ops[i].nameoff &&
+			    !sbi_strcmp(fdt_edit.ops[i].name, op->name)) {
+				op->nameoff = fdt_edit.ops[i].nameoff;
+				break;
+			}
+		}
+		if (op->nameoff >= 0)
+			continue;
+
+		op->nameoff = strings_size + extra;
+		extra += sbi_strlen(op->name) + 1;
+	}
+
+	/* Grow the blob once if the queued edits do not fit */
+	len = struct_off + struct_size + strings_size + grow + extra;
+	if (fdt_totalsize(fdt) < len) {
+		err = fdt_open_into(fdt, fdt, len);
+		if (err)
+			return err;
+		struct_off = fdt_off_dt_struct(fdt);
+		strtab = base + fdt_off_dt_strings(fdt);
+	}
+
+	/*
+	 * Move both blocks to the end of the blob so that the new
+	 * structure block can be written from the start without ever
+	 * catching up with the part which is not yet read.
+	 */
+	in_off = fdt_totalsize(fdt) - strings_size - struct_size;
+	sbi_memmove(base + in_off + struct_size, strtab, strings_size);
+	sbi_memmove(base + in_off, base + struct_off, struct_size);
+	fdt_set_off_dt_struct(fdt, in_off);
+	fdt_set_off_dt_strings(fdt, in_off + struct_size);
+
+	fdt_edit_sort_ops();
+
+	out = base + struct_off;
+	k = first = last = 0;
+	off = 0;
+	do {
+		tag = fdt_next_tag(fdt, off, &next);
+		if (next < 0)
+			return next;
+
+		if (tag == FDT_PROP) {
+			prop = fdt_offset_ptr(fdt, off, sizeof(*prop));
+			if (!prop)
+				return -FDT_ERR_BADSTRUCTURE;
+			nameoff = fdt32_to_cpu(prop->nameoff);
+			name = fdt_string(fdt, nameoff);
+			if (!name)
+				return -FDT_ERR_BADSTRUCTURE;
+			skip = false;
+			for (i = first; i < last; i++) {
+				op = &fdt_edit.ops[i];
+				if (op->type == FDT_EDIT_NOP_NODE ||
+				    sbi_strcmp(op->name, name))
+					continue;
+				if (op->type == FDT_EDIT_SETPROP)
+					out = fdt_edit_emit_prop(out, nameoff,
+						&fdt_edit.pool[op->val_off],
+						op->len);
+				op->applied = true;
+				skip = true;
+				break;
+			}
+			if (!skip) {
+				sbi_memmove(out, base + in_off + off,
+					    next - off);
+				out += next - off;
+			}
+			off = next;
+			continue;
+		}
+
+		if (tag == FDT_NOP) {
+			off = next;
+			continue;
+		}
+
+		/* Properties always come before subnodes and node end */
+		out = fdt_edit_emit_pending(out, first, last);
+		first = last;
+
+		if (tag == FDT_BEGIN_NODE) {
+			while (k < fdt_edit.op_count &&
+			       fdt_edit.ops[k].nodeoff < off)
+				k++;
+			first = last = k;
+			skip = false;
+			while (last < fdt_edit.op_count &&
+			       fdt_edit.ops[last].nodeoff == off) {
+				if (fdt_edit.ops[last].type == FDT_EDIT_NOP_NODE)
+					skip = true;
+				last++;
+			}
+			k = last;
+
+			if (skip) {
+				first = last;
+				depth = 1;
+				off = next;
+				while (depth > 0) {
+					tag = fdt_next_tag(fdt, off, &next);
+					if (next < 0)
+						return next;
+					if (tag == FDT_BEGIN_NODE)
+						depth++;
+					else if (tag == FDT_END_NODE)
+						depth--;
+					off = next;
+				}
+				continue;
+			}
+		}
+
+		sbi_memmove(out, base + in_off + off, next - off);
+		out += next - off;
+		off = next;
+	} while (tag != FDT_END);
+
+	/* Put back the strings block right after the new structure block */
+	struct_size = out - (base + struct_off);
+	sbi_memmove(out, base + in_off + fdt_size_dt_struct(fdt), strings_size);
+	for (k = 0; k < fdt_edit.op_count; k++) {
+		op = &fdt_edit.ops[k];
+		if (op->type == FDT_EDIT_SETPROP && strings_size <= op->nameoff)
+			sbi_memcpy(out + op->nameoff, op->name,
+				   sbi_strlen(op->name) + 1);
+	}
+	strings_size += extra;
+
+	fdt_set_off_dt_struct(fdt, struct_off);
+	fdt_set_size_dt_struct(fdt, struct_size);
+	fdt_set_off_dt_strings(fdt, struct_off + struct_size);
+	fdt_set_size_dt_strings(fdt, strings_size);
+
+	fdt_edit.op_count = 0;
+	fdt_edit.pool_used = 0;
+
+	return 0;
+}
+
+int fdt_edit_flush(void *fdt)
+{
+	if (!fdt_edit_active(fdt))
+		return 0;
+
+	return fdt_edit_apply(fdt);
+}
+
+int fdt_edit_run(void *fdt, int (*pass)(void *fdt, void *priv), void *priv)
+{
+	int err;
+
+	while (1) {
+		err = pass(fdt, priv);
+		if (err != -FDT_ERR_NOSPACE || !fdt_edit_active(fdt))
+			return err;
+
+		/*
+		 * The queue is full so apply it and redo the pass with
+		 * the new node offsets. Edits applied so far are skipped
+		 * by the pass so every round makes progress.
+		 */
+		err = fdt_edit_apply(fdt);
+		if (err)
+			return err;
+	}
+}
+
+int fdt_edit_commit(void *fdt)
+{
+	int err;
+
+	if (!fdt_edit_active(fdt))
+		return -FDT_ERR_BADSTATE;
+
+	err = fdt_edit_apply(fdt);
+	fdt_edit.fdt = NULL;
+	fdt_edit.op_count = 0;
+	fdt_edit.pool_used = 0;
+	if (err)
+		return err;
+
+	err = fdt_pack(fdt);
+	fdt_index_invalidate();
+
+	return err;
+}
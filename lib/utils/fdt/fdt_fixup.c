@@ -8,30 +8,29 @@
  */
 
 #include <libfdt.h>
+#include <sbi/sbi_boot_trace.h>
 #include <sbi/sbi_console.h>
 #include <sbi/sbi_domain.h>
 #include <sbi/sbi_math.h>
 #include <sbi/sbi_hart.h>
 #include <sbi/sbi_scratch.h>
 #include <sbi/sbi_string.h>
+#include <sbi/sbi_timer.h>
+#include <sbi_utils/fdt/fdt_edit.h>
 #include <sbi_utils/fdt/fdt_fixup.h>
 #include <sbi_utils/fdt/fdt_pmu.h>
 #include <sbi_utils/fdt/fdt_helper.h>
 
-void fdt_cpu_fixup(void *fdt)
+static int __fdt_cpu_fixup(void *fdt, void *priv)
 {
-	struct sbi_domain *dom = sbi_domain_thishart_ptr();
+	struct sbi_domain *dom = priv;
 	int err, cpu_offset, cpus_offset, len;
 	const char *mmu_type;
 	u32 hartid;
 
-	err = fdt_open_into(fdt, fdt, fdt_totalsize(fdt) + 32);
-	if (err < 0)
-		return;
-
 	cpus_offset = fdt_path_offset(fdt, "/cpus");
 	if (cpus_offset < 0)
-		return;
+		return 0;
 
 	fdt_for_each_subnode(cpu_offset, fdt, cpus_offset) {
 		err = fdt_parse_hart_id(fdt, cpu_offset, &hartid);
@@ -45,11 +44,29 @@ void fdt_cpu_fixup(void *fdt)
 		 */
 
 		mmu_type = fdt_getprop(fdt, cpu_offset, "mmu-type", &len);
-		if (!sbi_domain_is_assigned_hart(dom, hartid) ||
-		    !mmu_type || !len)
-			fdt_setprop_string(fdt, cpu_offset, "status",
-					   "disabled");
+		if (sbi_domain_is_assigned_hart(dom, hartid) &&
+		    mmu_type && len)
+			continue;
+
+		err = fdt_edit_disable_node(fdt, cpu_offset);
+		if (err < 0)
+			return err;
+	}
+
+	return 0;
+}
+
+int fdt_cpu_fixup(void *fdt)
+{
+	int err;
+
+	if (!fdt_edit_active(fdt)) {
+		err = fdt_open_into(fdt, fdt, fdt_totalsize(fdt) + 32);
+		if (err < 0)
+			return err;
 	}
+
+	return fdt_edit_run(fdt, __fdt_cpu_fixup, sbi_domain_thishart_ptr());
 }
 
 void fdt_plic_fixup(void *fdt)
@@ -58,9 +75,9 @@ void fdt_plic_fixup(void *fdt)
 	int i, cells_count;
 	int plic_off;
 
-	plic_off = fdt_node_offset_by_compatible(fdt, 0, "sifive,plic-1.0.0");
+	plic_off = fdt_index_node_by_compatible(fdt, 0, "sifive,plic-1.0.0");
 	if (plic_off < 0) {
-		plic_off = fdt_node_offset_by_compatible(fdt, 0, "riscv,plic0");
+		plic_off = fdt_index_node_by_compatible(fdt, 0, "riscv,plic0");
 		if (plic_off < 0)
 			return;
 	}
@@ -78,6 +95,9 @@ void fdt_plic_fixup(void *fdt)
 		if (fdt32_to_cpu(cells[2 * i + 1]) == IRQ_M_EXT)
 			cells[2 * i + 1] = cpu_to_fdt32(0xffffffff);
 	}
+
+	/* In-place edits are not detected by the FDT index */
+	fdt_index_invalidate();
 }
 
 static int fdt_resv_memory_update_node(void *fdt, unsigned long addr,
@@ -164,6 +184,11 @@ int fdt_reserved_memory_fixup(void *fdt)
 	int na = fdt_address_cells(fdt, 0);
 	int ns = fdt_size_cells(fdt, 0);
 
+	/* Adding nodes below moves node offsets of queued edits */
+	err = fdt_edit_flush(fdt);
+	if (err < 0)
+		return err;
+
 	/*
 	 * Expand the device tree to accommodate new node
 	 * by the following estimated size:
@@ -175,6 +200,9 @@ int fdt_reserved_memory_fixup(void *fdt)
 	if (err < 0)
 		return err;
 
+	/* The nodes added below move indexed nodes */
+	fdt_index_invalidate();
+
 	/* try to locate the reserved memory node */
 	parent = fdt_path_offset(fdt, "/reserved-memory");
 	if (parent < 0) {
@@ -245,6 +273,9 @@ int fdt_reserved_memory_nomap_fixup(void *fdt)
 	if (parent < 0)
 		return parent;
 
+	/* The properties added below move indexed nodes */
+	fdt_index_invalidate();
+
 	fdt_for_each_subnode(subnode, fdt, parent) {
 		/*
 		 * Tell operating system not to create a virtual
@@ -259,12 +290,89 @@ int fdt_reserved_memory_nomap_fixup(void *fdt)
 	return 0;
 }
 
+/**
+ * The boot phase timestamps live in firmware memory which is protected
+ * from S-mode by PMP, so we copy them into the device tree itself. The
+ * "sync-cycle" and "sync-time" pair is sampled back-to-back so that the
+ * next booting stage can convert MCYCLE values into its own timebase.
+ */
+int fdt_boot_trace_fixup(void *fdt)
+{
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	int err, chosen, node;
+	u64 ts;
+	u32 i;
+
+	if (!(scratch->options & SBI_SCRATCH_BOOT_TRACE))
+		return 0;
+
+	err = fdt_edit_flush(fdt);
+	if (err < 0)
+		return err;
+
+	/*
+	 * Expand the device tree to accommodate new node
+	 * by the following estimated size:
+	 *
+	 * Each boot phase takes at most 8 bytes of timestamp and
+	 * 8 bytes of name so 16 * 16 = 256 bytes plus node overhead.
+	 */
+	err = fdt_open_into(fdt, fdt, fdt_totalsize(fdt) + 512);
+	if (err < 0)
+		return err;
+
+	/* The nodes added below move indexed nodes */
+	fdt_index_invalidate();
+
+	chosen = fdt_path_offset(fdt, "/chosen");
+	if (chosen < 0) {
+		chosen = fdt_add_subnode(fdt, 0, "chosen");
+		if (chosen < 0)
+			return chosen;
+	}
+
+	node = fdt_add_subnode(fdt, chosen, "opensbi-boot-trace");
+	if (node < 0)
+		return node;
+
+	err = fdt_setprop_string(fdt, node, "compatible", "opensbi,boot-trace");
+	if (err < 0)
+		return err;
+
+	err = fdt_setprop_u32(fdt, node, "hart-id", current_hartid());
+	if (err < 0)
+		return err;
+
+	for (i = 0; i < SBI_BOOT_TRACE_PHASE_MAX; i++) {
+		ts = sbi_boot_trace_get(scratch, i);
+		if (!ts)
+			continue;
+
+		err = fdt_appendprop_string(fdt, node, "phase-names",
+					    sbi_boot_trace_phase_name(i));
+		if (err < 0)
+			return err;
+
+		err = fdt_appendprop_u64(fdt, node, "timestamps", ts);
+		if (err < 0)
+			return err;
+	}
+
+	err = fdt_setprop_u64(fdt, node, "sync-cycle",
+			      sbi_boot_trace_timestamp());
+	if (err < 0)
+		return err;
+
+	return fdt_setprop_u64(fdt, node, "sync-time", sbi_timer_value());
+}
+
 void fdt_fixups(void *fdt)
 {
 	fdt_plic_fixup(fdt);
 
 	fdt_reserved_memory_fixup(fdt);
 	fdt_pmu_fixup(fdt);
+	fdt_boot_trace_fixup(fdt);
 }
 
 
@@ -8,10 +8,12 @@
 
 #include <libfdt.h>
 #include <sbi/riscv_asm.h>
+#include <sbi/riscv_locks.h>
 #include <sbi/sbi_console.h>
 #include <sbi/sbi_hartmask.h>
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_scratch.h>
+#include <sbi/sbi_string.h>
 #include <sbi_utils/fdt/fdt_helper.h>
 #include <sbi_utils/irqchip/plic.h>
 
@@ -30,6 +32,328 @@
 #define DEFAULT_SHAKTI_UART_FREQ		50000000
 #define DEFAULT_SHAKTI_UART_BAUD		115200
 
+#ifndef FDT_INDEX_MAX_COMPATIBLES
+#define FDT_INDEX_MAX_COMPATIBLES	512
+#endif
+
+#ifndef FDT_INDEX_MAX_PHANDLES
+#define FDT_INDEX_MAX_PHANDLES		256
+#endif
+
+struct fdt_index_compat {
+	const char *compatible;
+	int offset;
+};
+
+struct fdt_index_phandle {
+	u32 phandle;
+	int offset;
+};
+
+/*
+ * Index of "compatible" strings and phandles built with a single walk
+ * over the device tree. The index is tagged with the blob address and
+ * header fields which change whenever libfdt moves nodes around, so
+ * any fdt_rw edit (or fdt_open_into) causes a rebuild on next lookup.
+ *
+ * When a table is full, the nodes up to compat_last (or phandle_last)
+ * stay indexed and lookups which miss the index scan the nodes after.
+ */
+static struct {
+	const void *fdt;
+	u32 totalsize;
+	u32 off_dt_struct;
+	u32 size_dt_struct;
+	u32 off_dt_strings;
+	bool valid;
+	bool compat_overflow;
+	bool phandle_overflow;
+	int compat_last;
+	int phandle_last;
+	u32 compat_count;
+	u32 phandle_count;
+	struct fdt_index_compat compats[FDT_INDEX_MAX_COMPATIBLES];
+	struct fdt_index_phandle phandles[FDT_INDEX_MAX_PHANDLES];
+} fdt_index;
+
+static spinlock_t fdt_index_lock = SPIN_LOCK_INITIALIZER;
+
+static int fdt_index_compat_cmp(const void *a, const void *b)
+{
+	const struct fdt_index_compat *ca = a, *cb = b;
+	int ret = sbi_strcmp(ca->compatible, cb->compatible);
+
+	if (ret)
+		return ret;
+
+	return ca->offset - cb->offset;
+}
+
+static int fdt_index_phandle_cmp(const void *a, const void *b)
+{
+	const struct fdt_index_phandle *pa = a, *pb = b;
+
+	if (pa->phandle != pb->phandle)
+		return (pa->phandle < pb->phandle) ? -1 : 1;
+
+	return pa->offset - pb->offset;
+}
+
+static void fdt_index_swap(char *a, char *b, size_t size)
+{
+	char tmp;
+
+	while (size--) {
+		tmp = *a;
+		*a++ = *b;
+		*b++ = tmp;
+	}
+}
+
+static void fdt_index_sift_down(char *base, u32 root, u32 num, size_t size,
+				int (*cmp)(const void *, const void *))
+{
+	u32 child;
+
+	while ((child = 2 * root + 1) < num) {
+		if (child + 1 < num &&
+		    cmp(base + child * size, base + (child + 1) * size) < 0)
+			child++;
+		if (cmp(base + root * size, base + child * size) >= 0)
+			return;
+		fdt_index_swap(base + root * size, base + child * size, size);
+		root = child;
+	}
+}
+
+/* In-place heap sort since we have no allocator for merge sort */
+static void fdt_index_sort(void *base, u32 num, size_t size,
+			   int (*cmp)(const void *, const void *))
+{
+	u32 i;
+
+	if (num < 2)
+		return;
+
+	for (i = num / 2; i > 0; i--)
+		fdt_index_sift_down(base, i - 1, num, size, cmp);
+
+	for (i = num - 1; i > 0; i--) {
+		fdt_index_swap(base, (char *)base + i * size, size);
+		fdt_index_sift_down(base, 0, i, size, cmp);
+	}
+}
+
+static bool fdt_index_is_current(const void *fdt)
+{
+	return fdt_index.valid && fdt_index.fdt == fdt &&
+	       fdt_index.totalsize == fdt_totalsize(fdt) &&
+	       fdt_index.off_dt_struct == fdt_off_dt_struct(fdt) &&
+	       fdt_index.size_dt_struct == fdt_size_dt_struct(fdt) &&
+	       fdt_index.off_dt_strings == fdt_off_dt_strings(fdt);
+}
+
+static void fdt_index_build(const void *fdt)
+{
+	const char *prop, *end;
+	int noff, prev, len;
+	u32 phandle, first;
+
+	fdt_index.valid = false;
+	fdt_index.compat_overflow = false;
+	fdt_index.phandle_overflow = false;
+	fdt_index.compat_count = 0;
+	fdt_index.phandle_count = 0;
+
+	if (fdt_check_header(fdt))
+		return;
+
+	for (prev = -1, noff = fdt_next_node(fdt, -1, NULL); noff >= 0;
+	     prev = noff, noff = fdt_next_node(fdt, noff, NULL)) {
+		prop = fdt_getprop(fdt, noff, "compatible", &len);
+		end = (prop && !fdt_index.compat_overflow) ? prop + len : NULL;
+		first = fdt_index.compat_count;
+		while (prop && prop < end) {
+			if (fdt_index.compat_count == FDT_INDEX_MAX_COMPATIBLES) {
+				/* Leave out all strings of this node */
+				fdt_index.compat_count = first;
+				fdt_index.compat_overflow = true;
+				fdt_index.compat_last = prev;
+				break;
+			}
+			fdt_index.compats[fdt_index.compat_count].compatible =
+									prop;
+			fdt_index.compats[fdt_index.compat_count].offset = noff;
+			fdt_index.compat_count++;
+			prop += sbi_strnlen(prop, end - prop) + 1;
+		}
+
+		phandle = fdt_get_phandle(fdt, noff);
+		if (!phandle || phandle == (u32)-1 ||
+		    fdt_index.phandle_overflow)
+			continue;
+		if (fdt_index.phandle_count == FDT_INDEX_MAX_PHANDLES) {
+			fdt_index.phandle_overflow = true;
+			fdt_index.phandle_last = prev;
+			continue;
+		}
+		fdt_index.phandles[fdt_index.phandle_count].phandle = phandle;
+		fdt_index.phandles[fdt_index.phandle_count].offset = noff;
+		fdt_index.phandle_count++;
+	}
+
+	fdt_index_sort(fdt_index.compats, fdt_index.compat_count,
+		       sizeof(fdt_index.compats[0]), fdt_index_compat_cmp);
+	fdt_index_sort(fdt_index.phandles, fdt_index.phandle_count,
+		       sizeof(fdt_index.phandles[0]), fdt_index_phandle_cmp);
+
+	fdt_index.fdt = fdt;
+	fdt_index.totalsize = fdt_totalsize(fdt);
+	fdt_index.off_dt_struct = fdt_off_dt_struct(fdt);
+	fdt_index.size_dt_struct = fdt_size_dt_struct(fdt);
+	fdt_index.off_dt_strings = fdt_off_dt_strings(fdt);
+	fdt_index.valid = true;
+}
+
+/* Must be called with fdt_index_lock held */
+static bool fdt_index_prepare(const void *fdt, bool rebuild)
+{
+	if (rebuild || !fdt_index_is_current(fdt))
+		fdt_index_build(fdt);
+
+	return fdt_index.valid;
+}
+
+static int fdt_index_lookup_compatible(const void *fdt, int startoff,
+				       const char *compatible)
+{
+	int ret;
+	u32 lo = 0, hi = fdt_index.compat_count, mid;
+	const struct fdt_index_compat *c;
+
+	/* Find first entry after (compatible, startoff) */
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		c = &fdt_index.compats[mid];
+		ret = sbi_strcmp(c->compatible, compatible);
+		if (ret < 0 || (!ret && c->offset <= startoff))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < fdt_index.compat_count &&
+	    !sbi_strcmp(fdt_index.compats[lo].compatible, compatible))
+		return fdt_index.compats[lo].offset;
+
+	/* Scan the nodes which did not fit into the index */
+	if (fdt_index.compat_overflow)
+		return fdt_node_offset_by_compatible(fdt,
+				(startoff < fdt_index.compat_last) ?
+				fdt_index.compat_last : startoff, compatible);
+
+	return -FDT_ERR_NOTFOUND;
+}
+
+static int fdt_index_lookup_phandle(const void *fdt, u32 phandle)
+{
+	u32 lo = 0, hi = fdt_index.phandle_count, mid;
+	int noff;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (fdt_index.phandles[mid].phandle < phandle)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < fdt_index.phandle_count &&
+	    fdt_index.phandles[lo].phandle == phandle)
+		return fdt_index.phandles[lo].offset;
+
+	/* Scan the nodes which did not fit into the index */
+	if (!fdt_index.phandle_overflow)
+		return -FDT_ERR_NOTFOUND;
+	for (noff = fdt_next_node(fdt, fdt_index.phandle_last, NULL);
+	     noff >= 0; noff = fdt_next_node(fdt, noff, NULL)) {
+		if (fdt_get_phandle(fdt, noff) == phandle)
+			return noff;
+	}
+
+	return noff;
+}
+
+void fdt_index_invalidate(void)
+{
+	spin_lock(&fdt_index_lock);
+	fdt_index.valid = false;
+	spin_unlock(&fdt_index_lock);
+}
+
+int fdt_index_node_by_compatible(void *fdt, int startoff,
+				 const char *compatible)
+{
+	int i, noff = -FDT_ERR_NOTFOUND;
+
+	if (!fdt || !compatible)
+		return -FDT_ERR_BADVALUE;
+
+	spin_lock(&fdt_index_lock);
+
+	for (i = 0; i < 2; i++) {
+		if (!fdt_index_prepare(fdt, i > 0)) {
+			noff = fdt_node_offset_by_compatible(fdt, startoff,
+							     compatible);
+			break;
+		}
+
+		/*
+		 * Double check the node in case it was changed in-place
+		 * (such as by fdt_nop_node()) and rebuild if needed.
+		 */
+		noff = fdt_index_lookup_compatible(fdt, startoff, compatible);
+		if (noff < 0 ||
+		    !fdt_node_check_compatible(fdt, noff, compatible))
+			break;
+	}
+	if (i == 2)
+		noff = fdt_node_offset_by_compatible(fdt, startoff, compatible);
+
+	spin_unlock(&fdt_index_lock);
+
+	return noff;
+}
+
+int fdt_index_node_by_phandle(void *fdt, u32 phandle)
+{
+	int i, noff = -FDT_ERR_NOTFOUND;
+
+	if (!fdt)
+		return -FDT_ERR_BADVALUE;
+	if (!phandle || phandle == (u32)-1)
+		return -FDT_ERR_BADPHANDLE;
+
+	spin_lock(&fdt_index_lock);
+
+	for (i = 0; i < 2; i++) {
+		if (!fdt_index_prepare(fdt, i > 0)) {
+			noff = fdt_node_offset_by_phandle(fdt, phandle);
+			break;
+		}
+
+		noff = fdt_index_lookup_phandle(fdt, phandle);
+		if (noff < 0 || fdt_get_phandle(fdt, noff) == phandle)
+			break;
+	}
+	if (i == 2)
+		noff = fdt_node_offset_by_phandle(fdt, phandle);
+
+	spin_unlock(&fdt_index_lock);
+
+	return noff;
+}
+
 const struct fdt_match *fdt_match_node(void *fdt, int nodeoff,
 				       const struct fdt_match *match_table)
 {
@@ -59,7 +383,7 @@ int fdt_find_match(void *fdt, int startoff,
 		return SBI_ENODEV;
 
 	while (match_table->compatible) {
-		nodeoff = fdt_node_offset_by_compatible(fdt, startoff,
+		nodeoff = fdt_index_node_by_compatible(fdt, startoff,
 						match_table->compatible);
 		if (nodeoff >= 0) {
 			if (out_match)
@@ -89,7 +413,7 @@ int fdt_parse_phandle_with_args(void *fdt, int nodeoff,
 	list_end = list + (len / sizeof(*list));
 
 	while (list < list_end) {
-		pnodeoff = fdt_node_offset_by_phandle(fdt,
+		pnodeoff = fdt_index_node_by_phandle(fdt,
 						fdt32_to_cpu(*list));
 		if (pnodeoff < 0)
 			return pnodeoff;
@@ -458,7 +782,7 @@ int fdt_parse_uart8250(void *fdt, struct platform_uart_data *uart,
 	if (!compatible || !uart || !fdt)
 		return SBI_ENODEV;
 
-	nodeoffset = fdt_node_offset_by_compatible(fdt, -1, compatible);
+	nodeoffset = fdt_index_node_by_compatible(fdt, -1, compatible);
 	if (nodeoffset < 0)
 		return nodeoffset;
 
@@ -494,7 +818,7 @@ int fdt_parse_plic(void *fdt, struct plic_data *plic, const char *compat)
 	if (!compat || !plic || !fdt)
 		return SBI_ENODEV;
 
-	nodeoffset = fdt_node_offset_by_compatible(fdt, -1, compat);
+	nodeoffset = fdt_index_node_by_compatible(fdt, -1, compat);
 	if (nodeoffset < 0)
 		return nodeoffset;
 
@@ -547,7 +871,7 @@ int fdt_parse_aclint_node(void *fdt, int nodeoffset, bool for_timer,
 		phandle = fdt32_to_cpu(val[2 * i]);
 		hwirq = fdt32_to_cpu(val[(2 * i) + 1]);
 
-		cpu_intc_offset = fdt_node_offset_by_phandle(fdt, phandle);
+		cpu_intc_offset = fdt_index_node_by_phandle(fdt, phandle);
 		if (cpu_intc_offset < 0)
 			continue;
 
@@ -585,7 +909,7 @@ int fdt_parse_compat_addr(void *fdt, uint64_t *addr,
 {
 	int nodeoffset, rc;
 
-	nodeoffset = fdt_node_offset_by_compatible(fdt, -1, compatible);
+	nodeoffset = fdt_index_node_by_compatible(fdt, -1, compatible);
 	if (nodeoffset < 0)
 		return nodeoffset;
 
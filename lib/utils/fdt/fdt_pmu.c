@@ -12,27 +12,40 @@
 #include <sbi/sbi_hart.h>
 #include <sbi/sbi_error.h>
 #include <sbi/sbi_pmu.h>
+#include <sbi_utils/fdt/fdt_edit.h>
 #include <sbi_utils/fdt/fdt_helper.h>
 
-#define FDT_PMU_HW_EVENT_MAX (SBI_PMU_HW_EVENT_MAX * 2)
-
-struct fdt_pmu_hw_event_select {
-	uint32_t eidx;
-	uint64_t select;
-};
-
-static struct fdt_pmu_hw_event_select fdt_pmu_evt_select[FDT_PMU_HW_EVENT_MAX] = {0};
-static uint32_t hw_event_count;
-
 uint64_t fdt_pmu_get_select_value(uint32_t event_idx)
 {
-	int i;
-	struct fdt_pmu_hw_event_select *event;
+	/* The select values are indexed along with the event map */
+	return sbi_pmu_get_event_select(event_idx);
+}
+
+static int __fdt_pmu_fixup(void *fdt, void *priv)
+{
+	static const char *const props[] = {
+		"riscv,event-to-mhpmcounters",
+		"riscv,event-to-mhpmevent",
+		"riscv,raw-event-to-mhpmcounters",
+		"interrupts-extended",
+	};
+	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
+	int i, err, pmu_offset, count = array_size(props);
 
-	for (i = 0; i < SBI_PMU_HW_EVENT_MAX; i++) {
-		event = &fdt_pmu_evt_select[i];
-		if (event->eidx == event_idx)
-			return event->select;
+	pmu_offset = fdt_index_node_by_compatible(fdt, -1, "riscv,pmu");
+	if (pmu_offset < 0)
+		return pmu_offset;
+
+	/* Keep the overflow interrupt if S-mode can use it */
+	if (sbi_hart_has_feature(scratch, SBI_HART_HAS_SSCOFPMF))
+		count--;
+
+	for (i = 0; i < count; i++) {
+		if (!fdt_getprop(fdt, pmu_offset, props[i], NULL))
+			continue;
+		err = fdt_edit_nop_property(fdt, pmu_offset, props[i]);
+		if (err < 0)
+			return err;
 	}
 
 	return 0;
@@ -40,38 +53,27 @@ uint64_t fdt_pmu_get_select_value(uint32_t event_idx)
 
 int fdt_pmu_fixup(void *fdt)
 {
-	int pmu_offset;
-	struct sbi_scratch *scratch = sbi_scratch_thishart_ptr();
-
 	if (!fdt)
 		return SBI_EINVAL;
 
-	pmu_offset = fdt_node_offset_by_compatible(fdt, -1, "riscv,pmu");
-	if (pmu_offset < 0)
+	if (fdt_edit_run(fdt, __fdt_pmu_fixup, NULL))
 		return SBI_EFAIL;
 
-	fdt_delprop(fdt, pmu_offset, "riscv,event-to-mhpmcounters");
-	fdt_delprop(fdt, pmu_offset, "riscv,event-to-mhpmevent");
-	fdt_delprop(fdt, pmu_offset, "riscv,raw-event-to-mhpmcounters");
-	if (!sbi_hart_has_feature(scratch, SBI_HART_HAS_SSCOFPMF))
-		fdt_delprop(fdt, pmu_offset, "interrupts-extended");
-
 	return 0;
 }
 
 int fdt_pmu_setup(void *fdt)
 {
-	int i, pmu_offset, len, result;
+	int i, pmu_offset, len;
 	const u32 *event_val;
 	const u32 *event_ctr_map;
-	struct fdt_pmu_hw_event_select *event;
-	uint64_t raw_selector, select_mask;
-	u32 event_idx_start, event_idx_end, ctr_map;
+	uint64_t raw_selector, select_mask, select;
+	u32 event_idx, event_idx_start, event_idx_end, ctr_map;
 
 	if (!fdt)
 		return SBI_EINVAL;
 
-	pmu_offset = fdt_node_offset_by_compatible(fdt, -1, "riscv,pmu");
+	pmu_offset = fdt_index_node_by_compatible(fdt, -1, "riscv,pmu");
 	if (pmu_offset < 0)
 		return SBI_EFAIL;
 
@@ -91,11 +93,10 @@ int fdt_pmu_setup(void *fdt)
 		return SBI_EFAIL;
 	len = len / (sizeof(u32) * 3);
 	for (i = 0; i < len; i++) {
-		event = &fdt_pmu_evt_select[hw_event_count];
-		event->eidx = fdt32_to_cpu(event_val[3 * i]);
-		event->select = fdt32_to_cpu(event_val[3 * i + 1]);
-		event->select = (event->select << 32) | fdt32_to_cpu(event_val[3 * i + 2]);
-		hw_event_count++;
+		event_idx = fdt32_to_cpu(event_val[3 * i]);
+		select = fdt32_to_cpu(event_val[3 * i + 1]);
+		select = (select << 32) | fdt32_to_cpu(event_val[3 * i + 2]);
+		sbi_pmu_add_event_select(event_idx, select);
 	}
 
 	event_val = fdt_getprop(fdt, pmu_offset, "riscv,raw-event-to-mhpmcounters", &len);
@@ -108,9 +109,7 @@ int fdt_pmu_setup(void *fdt)
 		select_mask = fdt32_to_cpu(event_val[5 * i + 2]);
 		select_mask = (select_mask  << 32) | fdt32_to_cpu(event_val[5 * i + 3]);
 		ctr_map = fdt32_to_cpu(event_val[5 * i + 4]);
-		result = sbi_pmu_add_raw_event_counter_map(raw_selector, select_mask, ctr_map);
-		if (!result)
-			hw_event_count++;
+		sbi_pmu_add_raw_event_counter_map(raw_selector, select_mask, ctr_map);
 	}
 
 	return 0;
@@ -35,6 +35,33 @@ static void mswi_ipi_send(u32 target_hart)
 	writel(1, &msip[target_hart - mswi->first_hartid]);
 }
 
+static void mswi_ipi_send_many(ulong hmask, ulong hbase)
+{
+	u32 *msip;
+	ulong hartid;
+	struct aclint_mswi_data *mswi;
+
+	/*
+	 * Each HART has its own MSIP register so there is no multicast
+	 * in hardware. Order prior memory writes once and then set all
+	 * MSIP registers back-to-back without a fence for each HART.
+	 */
+	wmb();
+	for (hartid = hbase; hmask; hartid++, hmask >>= 1) {
+		if (!(hmask & 1UL))
+			continue;
+		if (SBI_HARTMASK_MAX_BITS <= hartid)
+			break;
+		mswi = mswi_hartid2data[hartid];
+		if (!mswi)
+			continue;
+
+		/* Set ACLINT IPI */
+		msip = (void *)mswi->addr;
+		writel_relaxed(1, &msip[hartid - mswi->first_hartid]);
+	}
+}
+
 static void mswi_ipi_clear(u32 target_hart)
 {
 	u32 *msip;
@@ -54,7 +81,8 @@ static void mswi_ipi_clear(u32 target_hart)
 static struct sbi_ipi_device aclint_mswi = {
 	.name = "aclint-mswi",
 	.ipi_send = mswi_ipi_send,
-	.ipi_clear = mswi_ipi_clear
+	.ipi_clear = mswi_ipi_clear,
+	.ipi_send_many = mswi_ipi_send_many
 };
 
 int aclint_mswi_warm_init(void)
@@ -49,7 +49,7 @@ static int irqchip_plic_update_hartid_table(void *fdt, int nodeoff,
 		phandle = fdt32_to_cpu(val[i]);
 		hwirq = fdt32_to_cpu(val[i + 1]);
 
-		cpu_intc_offset = fdt_node_offset_by_phandle(fdt, phandle);
+		cpu_intc_offset = fdt_index_node_by_phandle(fdt, phandle);
 		if (cpu_intc_offset < 0)
 			continue;
 
@@ -7,10 +7,13 @@
  *   Anup Patel <anup.patel@wdc.com>
  */
 
+#include <sbi/riscv_asm.h>
 #include <sbi/riscv_io.h>
 #include <sbi/riscv_encoding.h>
 #include <sbi/sbi_console.h>
 #include <sbi/sbi_error.h>
+#include <sbi/sbi_irqchip.h>
+#include <sbi/sbi_scratch.h>
 #include <sbi/sbi_string.h>
 #include <sbi_utils/irqchip/plic.h>
 
@@ -20,6 +23,36 @@
 #define PLIC_ENABLE_STRIDE 0x80
 #define PLIC_CONTEXT_BASE 0x200000
 #define PLIC_CONTEXT_STRIDE 0x1000
+#define PLIC_CONTEXT_CLAIM 0x4
+
+#define PLIC_M_IRQ_HANDLER_MAX 16
+
+struct plic_m_irq_handler {
+	struct plic_data *plic;
+	u32 hartid;
+	u32 hwirq;
+	int (*handler)(u32 hwirq, void *priv);
+	void *priv;
+};
+
+static struct plic_m_irq_handler plic_m_irq_handlers[PLIC_M_IRQ_HANDLER_MAX];
+static u32 plic_m_irq_handler_count;
+
+/* PLIC and M-mode context of a HART, set by plic_warm_irqchip_init() */
+struct plic_m_hart {
+	struct plic_data *plic;
+	int context;
+};
+
+static unsigned long plic_m_hart_off;
+
+static struct plic_m_hart *plic_m_thishart_ptr(void)
+{
+	if (!plic_m_hart_off)
+		return NULL;
+
+	return sbi_scratch_thishart_offset_ptr(plic_m_hart_off);
+}
 
 static void plic_set_priority(struct plic_data *plic, u32 source, u32 val)
 {
@@ -52,14 +85,120 @@ void plic_set_ie(struct plic_data *plic, u32 cntxid, u32 word_index, u32 val)
 	writel(val, plic_ie + word_index * 4);
 }
 
+static void plic_set_ie_bit(struct plic_data *plic, u32 cntxid,
+			    u32 hwirq, bool enable)
+{
+	volatile void *plic_ie;
+	u32 val;
+
+	plic_ie = (void *)plic->addr + PLIC_ENABLE_BASE +
+		  PLIC_ENABLE_STRIDE * cntxid + (hwirq / 32) * 4;
+	val = readl(plic_ie);
+	if (enable)
+		val |= 1U << (hwirq % 32);
+	else
+		val &= ~(1U << (hwirq % 32));
+	writel(val, plic_ie);
+}
+
+static struct plic_m_irq_handler *plic_m_irq_find(struct plic_data *plic,
+						  u32 hwirq)
+{
+	u32 i;
+
+	for (i = 0; i < plic_m_irq_handler_count; i++) {
+		if (plic_m_irq_handlers[i].plic == plic &&
+		    plic_m_irq_handlers[i].hwirq == hwirq)
+			return &plic_m_irq_handlers[i];
+	}
+
+	return NULL;
+}
+
+static int plic_m_irq_process(struct sbi_trap_regs *regs)
+{
+	int rc = 0;
+	u32 hwirq;
+	struct plic_m_hart *mh = plic_m_thishart_ptr();
+	struct plic_m_irq_handler *h;
+	struct plic_data *plic;
+	volatile void *claim;
+
+	if (!mh || !mh->plic)
+		return SBI_ENODEV;
+	plic = mh->plic;
+
+	claim = (void *)plic->addr + PLIC_CONTEXT_BASE +
+		PLIC_CONTEXT_STRIDE * mh->context + PLIC_CONTEXT_CLAIM;
+
+	while (!rc && (hwirq = readl(claim))) {
+		h = plic_m_irq_find(plic, hwirq);
+		if (h) {
+			rc = h->handler(hwirq, h->priv);
+		} else {
+			/* Nobody will ever clear it, so keep it quiet */
+			plic_set_ie_bit(plic, mh->context, hwirq, FALSE);
+			sbi_printf("%s: disabled spurious source %u\n",
+				   __func__, hwirq);
+		}
+		writel(hwirq, claim);
+	}
+
+	return rc;
+}
+
+int plic_m_irq_register(u32 hwirq, u32 priority,
+			int (*handler)(u32 hwirq, void *priv), void *priv)
+{
+	struct plic_m_hart *mh = plic_m_thishart_ptr();
+	struct plic_m_irq_handler *h;
+	struct plic_data *plic;
+	int cntxid;
+
+	if (!mh || !mh->plic)
+		return SBI_ENODEV;
+	plic = mh->plic;
+	cntxid = mh->context;
+
+	if (!handler || !priority || !hwirq || plic->num_src < hwirq)
+		return SBI_EINVAL;
+	if (plic_m_irq_find(plic, hwirq))
+		return SBI_EALREADY;
+	if (PLIC_M_IRQ_HANDLER_MAX <= plic_m_irq_handler_count)
+		return SBI_ENOSPC;
+
+	h = &plic_m_irq_handlers[plic_m_irq_handler_count++];
+	h->plic = plic;
+	h->hartid = current_hartid();
+	h->hwirq = hwirq;
+	h->handler = handler;
+	h->priv = priv;
+
+	plic_set_priority(plic, hwirq, priority);
+	plic_set_ie_bit(plic, cntxid, hwirq, TRUE);
+	plic_set_thresh(plic, cntxid, 0);
+
+	sbi_irqchip_set_irqfn(plic_m_irq_process);
+	csr_set(CSR_MIE, MIP_MEIP);
+
+	return 0;
+}
+
 int plic_warm_irqchip_init(struct plic_data *plic,
 			   int m_cntx_id, int s_cntx_id)
 {
 	size_t i, ie_words;
+	u32 hartid = current_hartid();
+	struct plic_m_hart *mh = plic_m_thishart_ptr();
 
 	if (!plic)
 		return SBI_EINVAL;
 
+	if (m_cntx_id > -1 && mh) {
+		mh->plic = plic;
+		mh->context = m_cntx_id;
+	}
+
 	ie_words = plic->num_src / 32 + 1;
 
 	/* By default, disable all IRQs for M-mode of target HART */
@@ -82,6 +221,16 @@ int plic_warm_irqchip_init(struct plic_data *plic,
 	if (s_cntx_id > -1)
 		plic_set_thresh(plic, s_cntx_id, 0x7);
 
+	/* Re-enable M-mode IRQs registered by this HART before a reset */
+	for (i = 0; m_cntx_id > -1 && i < plic_m_irq_handler_count; i++) {
+		if (plic_m_irq_handlers[i].plic != plic ||
+		    plic_m_irq_handlers[i].hartid != hartid)
+			continue;
+		plic_set_ie_bit(plic, m_cntx_id,
+				plic_m_irq_handlers[i].hwirq, TRUE);
+		plic_set_thresh(plic, m_cntx_id, 0);
+	}
+
 	return 0;
 }
 
@@ -92,6 +241,13 @@ int plic_cold_irqchip_init(struct plic_data *plic)
 	if (!plic)
 		return SBI_EINVAL;
 
+	if (!plic_m_hart_off) {
+		plic_m_hart_off =
+			sbi_scratch_alloc_offset(sizeof(struct plic_m_hart));
+		if (!plic_m_hart_off)
+			return SBI_ENOMEM;
+	}
+
 	/* Configure default priorities of all IRQs */
 	for (i = 1; i <= plic->num_src; i++)
 		plic_set_priority(plic, i, 0);
@@ -41,6 +41,12 @@ typedef uint16_t FDT_BITWISE fdt16_t;
 typedef uint32_t FDT_BITWISE fdt32_t;
 typedef uint64_t FDT_BITWISE fdt64_t;
 
+#ifdef __riscv_zbb
+/* Little-endian RISC-V with Zbb swaps bytes with rev8 */
+#define CPU_TO_FDT16(x) __builtin_bswap16(x)
+#define CPU_TO_FDT32(x) __builtin_bswap32(x)
+#define CPU_TO_FDT64(x) __builtin_bswap64(x)
+#else
 #define EXTRACT_BYTE(x, n)	((unsigned long long)((uint8_t *)&x)[n])
 #define CPU_TO_FDT16(x) ((EXTRACT_BYTE(x, 0) << 8) | EXTRACT_BYTE(x, 1))
 #define CPU_TO_FDT32(x) ((EXTRACT_BYTE(x, 0) << 24) | (EXTRACT_BYTE(x, 1) << 16) | \
@@ -49,6 +55,7 @@ typedef uint64_t FDT_BITWISE fdt64_t;
 			 (EXTRACT_BYTE(x, 2) << 40) | (EXTRACT_BYTE(x, 3) << 32) | \
 			 (EXTRACT_BYTE(x, 4) << 24) | (EXTRACT_BYTE(x, 5) << 16) | \
 			 (EXTRACT_BYTE(x, 6) << 8) | EXTRACT_BYTE(x, 7))
+#endif
 
 static inline uint16_t fdt16_to_cpu(fdt16_t x)
 {
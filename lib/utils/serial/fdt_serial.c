@@ -32,6 +32,7 @@ static struct fdt_serial *serial_drivers[] = {
 static struct fdt_serial dummy = {
 	.match_table = NULL,
 	.init = NULL,
+	.irq_init = NULL,
 };
 
 static struct fdt_serial *current_driver = &dummy;
@@ -106,3 +107,11 @@ int fdt_serial_init(void)
 done:
 	return 0;
 }
+
+int fdt_serial_irq_init(void)
+{
+	if (current_driver->irq_init)
+		return current_driver->irq_init();
+
+	return 0;
+}
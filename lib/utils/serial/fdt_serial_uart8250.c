@@ -7,24 +7,56 @@
  *   Anup Patel <anup.patel@wdc.com>
  */
 
+#include <libfdt.h>
+#include <sbi/riscv_encoding.h>
+#include <sbi/sbi_domain.h>
 #include <sbi_utils/fdt/fdt_helper.h>
 #include <sbi_utils/serial/fdt_serial.h>
 #include <sbi_utils/serial/uart8250.h>
 
+static unsigned long uart8250_addr;
+static u32 uart8250_hwirq;
+
 static int serial_uart8250_init(void *fdt, int nodeoff,
 				const struct fdt_match *match)
 {
-	int rc;
+	int rc, len;
+	const fdt32_t *val;
 	struct platform_uart_data uart;
 
 	rc = fdt_parse_uart8250_node(fdt, nodeoff, &uart);
 	if (rc)
 		return rc;
 
+	uart8250_addr = uart.addr;
+	val = fdt_getprop(fdt, nodeoff, "interrupts", &len);
+	if (val && len >= (int)sizeof(*val))
+		uart8250_hwirq = fdt32_to_cpu(*val);
+
 	return uart8250_init(uart.addr, uart.freq, uart.baud,
 			     uart.reg_shift, uart.reg_io_width);
 }
 
+static int serial_uart8250_irq_init(void)
+{
+	struct sbi_domain *dom;
+	u32 i;
+
+	if (!uart8250_hwirq)
+		return 0;
+
+	/* S-mode takes the interrupt itself if any domain can access it */
+	sbi_domain_for_each(i, dom) {
+		if (sbi_domain_check_addr(dom, uart8250_addr, PRV_S,
+					  SBI_DOMAIN_READ) ||
+		    sbi_domain_check_addr(dom, uart8250_addr, PRV_S,
+					  SBI_DOMAIN_READ | SBI_DOMAIN_MMIO))
+			return 0;
+	}
+
+	return uart8250_rx_irq_init(uart8250_hwirq);
+}
+
 static const struct fdt_match serial_uart8250_match[] = {
 	{ .compatible = "ns16550" },
 	{ .compatible = "ns16550a" },
@@ -35,4 +67,5 @@ static const struct fdt_match serial_uart8250_match[] = {
 struct fdt_serial fdt_serial_uart8250 = {
 	.match_table = serial_uart8250_match,
 	.init = serial_uart8250_init,
+	.irq_init = serial_uart8250_irq_init,
 };
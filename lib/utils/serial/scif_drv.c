@@ -64,6 +64,10 @@
 
 #define SCIF_LSR_ORER       (0x0001U)    /* Overrun error flag */
 
+#define SCIF_FDR_T_SHIFT    (8U)         /* Untransmitted data count (bit[12:8]) */
+#define SCIF_FDR_T_MASK     (0x001FU)
+#define SCIF_TX_FIFO_SIZE   (16U)        /* Transmit FIFO stages */
+
 
 #define SCIF_SPTR_SPB2DT    (0x0001U)    /* if SCR.TE setting, don't care */
 #define SCIF_SPTR_SPB2IO    (0x0002U)    /* if SCR.TE setting, don't care */
@@ -93,9 +97,11 @@ static u32 scif_baudrate;
  Private (static) variables and functions
  */
 static void scif_wait(unsigned long);
+static unsigned long scif_puts(const char *str, unsigned long len);
 static struct sbi_console_device scif_console = {
     .name         = "scif",
     .console_putc = scif_put_char,
+    .console_puts = scif_puts,
 };
 
 static u32 get_reg(u32 offset)
@@ -189,6 +195,38 @@ void scif_put_char(char outChar)
  * End of function scif_put_char
  */
 
+/*
+ * Function Name: scif_puts
+ * Description  : Put characters via SCIF, filling the free transmit FIFO stages.
+ * Arguments    : str : output characters.
+                  len : number of characters.
+ * Return Value : number of characters written.
+ */
+static unsigned long scif_puts(const char *str, unsigned long len)
+{
+	unsigned long i, room;
+	uint16_t reg;
+
+	do {
+		room = SCIF_TX_FIFO_SIZE -
+		       ((get_reg(SCIF_FDR_0_OFFSET) >> SCIF_FDR_T_SHIFT) & SCIF_FDR_T_MASK);
+	} while (!room);
+
+	if (room > len)
+		room = len;
+	for (i = 0; i < room; i++)
+		set_reg(SCIF_FTDR_0_OFFSET, str[i]);
+
+	reg = get_reg(SCIF_FSR_0_OFFSET);
+	reg &= (~SCIF_FSR_TXD_CHK); /* Clear TEND and TDFE flag */
+	set_reg(SCIF_FSR_0_OFFSET, reg);
+
+	return room;
+}
+/*
+ * End of function scif_puts
+ */
+
 /*
  * Function Name: scif_wait
  * Description  : wait for timeout of specified period.
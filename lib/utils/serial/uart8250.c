@@ -7,8 +7,10 @@
  *   Anup Patel <anup.patel@wdc.com>
  */
 
+#include <sbi/riscv_barrier.h>
 #include <sbi/riscv_io.h>
 #include <sbi/sbi_console.h>
+#include <sbi_utils/irqchip/plic.h>
 #include <sbi_utils/serial/uart8250.h>
 
 /* clang-format off */
@@ -27,6 +29,8 @@
 #define UART_SCR_OFFSET		7	/* I/O: Scratch Register */
 #define UART_MDR1_OFFSET	8	/* I/O:  Mode Register */
 
+#define UART_IER_RDI		0x01	/* Receiver data interrupt */
+
 #define UART_LSR_FIFOE		0x80	/* Fifo error */
 #define UART_LSR_TEMT		0x40	/* Transmitter empty */
 #define UART_LSR_THRE		0x20	/* Transmit-hold-register empty */
@@ -37,6 +41,10 @@
 #define UART_LSR_DR		0x01	/* Receiver data ready */
 #define UART_LSR_BRK_ERROR_BITS	0x1E	/* BI, FE, PE, OE bits */
 
+#define UART_IIR_FIFO_ENABLED	0xC0	/* FIFOs enabled (16550 and later) */
+#define UART_FIFO_DEPTH		16	/* TX FIFO depth of 16550 */
+#define UART_RX_BUF_SIZE	64	/* Must be a power of 2 */
+
 /* clang-format on */
 
 static volatile void *uart8250_base;
@@ -44,6 +52,13 @@ static u32 uart8250_in_freq;
 static u32 uart8250_baudrate;
 static u32 uart8250_reg_width;
 static u32 uart8250_reg_shift;
+static u32 uart8250_fifo_depth;
+
+/* Characters received by the RX interrupt handler, once enabled */
+static bool uart8250_rx_irq_enabled;
+static u8 uart8250_rx_buf[UART_RX_BUF_SIZE];
+static volatile u32 uart8250_rx_head;
+static volatile u32 uart8250_rx_tail;
 
 static u32 get_reg(u32 num)
 {
@@ -77,16 +92,79 @@ static void uart8250_putc(char ch)
 	set_reg(UART_THR_OFFSET, ch);
 }
 
+static unsigned long uart8250_puts(const char *str, unsigned long len)
+{
+	unsigned long i;
+
+	/* THRE means the whole TX FIFO is empty */
+	while ((get_reg(UART_LSR_OFFSET) & UART_LSR_THRE) == 0)
+		;
+
+	if (len > uart8250_fifo_depth)
+		len = uart8250_fifo_depth;
+	for (i = 0; i < len; i++)
+		set_reg(UART_THR_OFFSET, str[i]);
+
+	return len;
+}
+
 static int uart8250_getc(void)
 {
+	u32 tail = uart8250_rx_tail;
+	int ch;
+
+	/* The RX interrupt handler owns the receive buffer register */
+	if (uart8250_rx_irq_enabled) {
+		if (tail == uart8250_rx_head)
+			return -1;
+		smp_rmb();
+		ch = uart8250_rx_buf[tail & (UART_RX_BUF_SIZE - 1)];
+		smp_mb();
+		uart8250_rx_tail = tail + 1;
+		return ch;
+	}
+
 	if (get_reg(UART_LSR_OFFSET) & UART_LSR_DR)
 		return get_reg(UART_RBR_OFFSET);
 	return -1;
 }
 
+static int uart8250_rx_irq(u32 hwirq, void *priv)
+{
+	u32 head = uart8250_rx_head;
+	u8 ch;
+
+	/* Drain the RX FIFO, dropping what does not fit into the buffer */
+	while (get_reg(UART_LSR_OFFSET) & UART_LSR_DR) {
+		ch = get_reg(UART_RBR_OFFSET);
+		if (head - uart8250_rx_tail < UART_RX_BUF_SIZE)
+			uart8250_rx_buf[head++ & (UART_RX_BUF_SIZE - 1)] = ch;
+	}
+
+	smp_wmb();
+	uart8250_rx_head = head;
+
+	return 0;
+}
+
+int uart8250_rx_irq_init(u32 hwirq)
+{
+	int rc;
+
+	rc = plic_m_irq_register(hwirq, 1, uart8250_rx_irq, NULL);
+	if (rc)
+		return rc;
+
+	uart8250_rx_irq_enabled = TRUE;
+	set_reg(UART_IER_OFFSET, UART_IER_RDI);
+
+	return 0;
+}
+
 static struct sbi_console_device uart8250_console = {
 	.name = "uart8250",
 	.console_putc = uart8250_putc,
+	.console_puts = uart8250_puts,
 	.console_getc = uart8250_getc
 };
 
@@ -119,6 +197,12 @@ int uart8250_init(unsigned long base, u32 in_freq, u32 baudrate, u32 reg_shift,
 	set_reg(UART_LCR_OFFSET, 0x03);
 	/* Enable FIFO */
 	set_reg(UART_FCR_OFFSET, 0x01);
+	/* Plain 8250/16450 has no FIFO so one character at a time */
+	if ((get_reg(UART_IIR_OFFSET) & UART_IIR_FIFO_ENABLED) ==
+	    UART_IIR_FIFO_ENABLED)
+		uart8250_fifo_depth = UART_FIFO_DEPTH;
+	else
+		uart8250_fifo_depth = 1;
 	/* No modem control DTR RTS */
 	set_reg(UART_MCR_OFFSET, 0x00);
 	/* Clear line status */
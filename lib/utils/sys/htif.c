@@ -117,6 +117,19 @@ static void htif_putc(char ch)
 	__set_tohost(HTIF_DEV_CONSOLE, HTIF_CONSOLE_CMD_PUTC, ch);
 	spin_unlock(&htif_lock);
 }
+
+static unsigned long htif_puts(const char *str, unsigned long len)
+{
+	unsigned long i;
+
+	/* The console device takes one character per command */
+	spin_lock(&htif_lock);
+	for (i = 0; i < len; i++)
+		__set_tohost(HTIF_DEV_CONSOLE, HTIF_CONSOLE_CMD_PUTC, str[i]);
+	spin_unlock(&htif_lock);
+
+	return len;
+}
 #endif
 
 static int htif_getc(void)
@@ -145,6 +158,9 @@ static int htif_getc(void)
 static struct sbi_console_device htif_console = {
 	.name = "htif",
 	.console_putc = htif_putc,
+#if __riscv_xlen != 32
+	.console_puts = htif_puts,
+#endif
 	.console_getc = htif_getc
 };
 
@@ -90,7 +90,8 @@ static int ae350_irqchip_init(bool cold_boot)
 static struct sbi_ipi_device plicsw_ipi = {
 	.name = "ae350_plicsw",
 	.ipi_send = plicsw_ipi_send,
-	.ipi_clear = plicsw_ipi_clear
+	.ipi_clear = plicsw_ipi_clear,
+	.ipi_send_many = plicsw_ipi_send_many
 };
 
 /* Initialize IPI for current HART. */
@@ -72,6 +72,30 @@ void plicsw_ipi_send(u32 target_hart)
 	plic_sw_pending(target_hart);
 }
 
+void plicsw_ipi_send_many(ulong hmask, ulong hbase)
+{
+	/*
+	 * All target bits live in the pending region of the source HART
+	 * (see plic_sw_pending()) so one write sends all the IPIs.
+	 */
+	u32 source_hart = current_hartid();
+	u32 per_hart_offset = PLICSW_PENDING_PER_HART * source_hart;
+	u32 target_hart, val = 0;
+
+	for (target_hart = hbase; hmask; target_hart++, hmask >>= 1) {
+		if (plicsw_ipi_hart_count <= target_hart)
+			break;
+		if (hmask & 1UL)
+			val |= 1 << ((PLICSW_PENDING_PER_HART - 1) -
+				     target_hart);
+	}
+
+	/* Set PLICSW IPIs */
+	if (val)
+		writel(val << per_hart_offset,
+		       plicsw_dev[source_hart].plicsw_pending);
+}
+
 void plicsw_ipi_clear(u32 target_hart)
 {
 	if (plicsw_ipi_hart_count <= target_hart)
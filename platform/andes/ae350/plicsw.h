@@ -35,6 +35,8 @@ struct plicsw {
 
 void plicsw_ipi_send(u32 target_hart);
 
+void plicsw_ipi_send_many(ulong hmask, ulong hbase);
+
 void plicsw_ipi_clear(u32 target_hart);
 
 int plicsw_warm_ipi_init(void);
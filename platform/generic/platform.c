@@ -10,10 +10,12 @@
 #include <libfdt.h>
 #include <platform_override.h>
 #include <sbi/riscv_asm.h>
+#include <sbi/sbi_console.h>
 #include <sbi/sbi_hartmask.h>
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_string.h>
 #include <sbi_utils/fdt/fdt_domain.h>
+#include <sbi_utils/fdt/fdt_edit.h>
 #include <sbi_utils/fdt/fdt_fixup.h>
 #include <sbi_utils/fdt/fdt_helper.h>
 #include <sbi_utils/fdt/fdt_pmu.h>
@@ -126,10 +128,27 @@ static int generic_early_init(bool cold_boot)
 	return generic_plat->early_init(cold_boot, generic_plat_match);
 }
 
+/* The fixups are best-effort so that S-mode can still boot on failure */
+static void generic_fdt_fixups(void *fdt)
+{
+	int rc;
+
+	rc = fdt_cpu_fixup(fdt);
+	if (rc)
+		sbi_printf("%s: CPU fixup failed (error %d)\n", __func__, rc);
+
+	fdt_fixups(fdt);
+
+	rc = fdt_domain_fixup(fdt);
+	if (rc)
+		sbi_printf("%s: domain fixup failed (error %d)\n", __func__, rc);
+}
+
 static int generic_final_init(bool cold_boot)
 {
 	void *fdt;
 	int rc;
+	bool edit;
 
 	if (cold_boot)
 		fdt_reset_init();
@@ -143,11 +162,24 @@ static int generic_final_init(bool cold_boot)
 	if (!cold_boot)
 		return 0;
 
+	rc = fdt_serial_irq_init();
+	if (rc)
+		sbi_printf("%s: console interrupt init failed (error %d)\n",
+			   __func__, rc);
+
 	fdt = fdt_get_address();
 
-	fdt_cpu_fixup(fdt);
-	fdt_fixups(fdt);
-	fdt_domain_fixup(fdt);
+	/* Batch the fixups and redo them one by one if the batch fails */
+	edit = !fdt_edit_begin(fdt);
+	generic_fdt_fixups(fdt);
+	if (edit) {
+		rc = fdt_edit_commit(fdt);
+		if (rc) {
+			sbi_printf("%s: batched FDT fixups failed (error %d)\n",
+				   __func__, rc);
+			generic_fdt_fixups(fdt);
+		}
+	}
 
 	if (generic_plat && generic_plat->fdt_fixup) {
 		rc = generic_plat->fdt_fixup(fdt, generic_plat_match);
@@ -12,8 +12,59 @@
 #include <sbi/riscv_asm.h>
 #include <sbi/riscv_io.h>
 #include <sbi/sbi_types.h>
+#include <sbi_utils/cache/andes_l2c.h>
 #include "platform.h"
 
+/* L1 D-cache line size (0 if no D-cache) */
+static unsigned long l1d_line_size;
+/* Range size above which whole cache operations are cheaper */
+static unsigned long l1d_range_max;
+/* mcctlbeginaddr moves to the next line after each VA based command */
+static bool l1d_cctl_autoinc;
+
+void cache_range_init(void)
+{
+	unsigned long mdcm_cfg = csr_read(CSR_MDCM_CFG);
+	unsigned long dsz, sets, ways;
+
+	dsz = (mdcm_cfg & V5_MDCM_CFG_DSZ_MASK) >> V5_MDCM_CFG_DSZ_OFFSET;
+	if (!dsz)
+		return;
+
+	l1d_line_size = 1UL << (dsz + 2);
+	sets = 1UL << (((mdcm_cfg & V5_MDCM_CFG_DSET_MASK) >>
+			V5_MDCM_CFG_DSET_OFFSET) + 6);
+	ways = ((mdcm_cfg & V5_MDCM_CFG_DWAY_MASK) >>
+		V5_MDCM_CFG_DWAY_OFFSET) + 1;
+
+	/*
+	 * Walking more lines than the cache holds costs more than the
+	 * whole cache operation, so use the cache size as the limit.
+	 */
+	l1d_range_max = sets * ways * l1d_line_size;
+
+	l1d_cctl_autoinc = (csr_read(CSR_MMSC_CFG) & V5_MMSC_CFG_VCCTL_MASK) ?
+			   TRUE : FALSE;
+}
+
+static void l1d_range_op(unsigned long start, unsigned long end,
+			 unsigned long cmd)
+{
+	if (start >= end)
+		return;
+
+	if (l1d_cctl_autoinc) {
+		csr_write(CSR_MCCTLBEGINADDR, start);
+		for (; start < end; start += l1d_line_size)
+			csr_write(CSR_MCCTLCOMMAND, cmd);
+	} else {
+		for (; start < end; start += l1d_line_size) {
+			csr_write(CSR_MCCTLBEGINADDR, start);
+			csr_write(CSR_MCCTLCOMMAND, cmd);
+		}
+	}
+}
+
 uintptr_t mcall_set_mcache_ctl(unsigned long input)
 {
 	csr_clear(CSR_MCACHECTL, V5_MCACHE_CTL_MASK);
@@ -57,6 +108,102 @@ uintptr_t mcall_dcache_wbinval_all(void)
 	return 0;
 }
 
+static void l1d_wb_range(unsigned long addr, unsigned long size)
+{
+	if (!l1d_line_size)
+		return;
+
+	if (size > l1d_range_max) {
+		csr_write(CSR_MCCTLCOMMAND, V5_UCCTL_L1D_WB_ALL);
+		return;
+	}
+
+	l1d_range_op(addr & ~(l1d_line_size - 1), addr + size,
+		     V5_UCCTL_L1D_VA_WB);
+}
+
+static void l1d_inval_range(unsigned long addr, unsigned long size)
+{
+	unsigned long start, end;
+
+	if (!l1d_line_size)
+		return;
+
+	/* Dirty lines of other buffers must not be dropped */
+	if (size > l1d_range_max) {
+		csr_write(CSR_MCCTLCOMMAND, V5_UCCTL_L1D_WBINVAL_ALL);
+		return;
+	}
+
+	start = addr & ~(l1d_line_size - 1);
+	end = ROUNDUP(addr + size, l1d_line_size);
+
+	/* Partial lines at the edges may hold other data, so write them back */
+	if (start != addr) {
+		l1d_range_op(start, start + l1d_line_size,
+			     V5_UCCTL_L1D_VA_WBINVAL);
+		start += l1d_line_size;
+	}
+	if (end != addr + size && start < end) {
+		l1d_range_op(end - l1d_line_size, end,
+			     V5_UCCTL_L1D_VA_WBINVAL);
+		end -= l1d_line_size;
+	}
+	l1d_range_op(start, end, V5_UCCTL_L1D_VA_INVAL);
+}
+
+static void l1d_wbinval_range(unsigned long addr, unsigned long size)
+{
+	if (!l1d_line_size)
+		return;
+
+	if (size > l1d_range_max) {
+		csr_write(CSR_MCCTLCOMMAND, V5_UCCTL_L1D_WBINVAL_ALL);
+		return;
+	}
+
+	l1d_range_op(addr & ~(l1d_line_size - 1), addr + size,
+		     V5_UCCTL_L1D_VA_WBINVAL);
+}
+
+/*
+ * The range operations below cover both cache levels so that a buffer
+ * is coherent with DMA masters once they return. L1 goes first so that
+ * lines it writes back are pushed on to memory by the L2 operation.
+ */
+uintptr_t mcall_dcache_wb_range(unsigned long addr, unsigned long size)
+{
+	if (!size)
+		return 0;
+
+	l1d_wb_range(addr, size);
+	andes_l2c_wb_range(addr, size);
+
+	return 0;
+}
+
+uintptr_t mcall_dcache_inval_range(unsigned long addr, unsigned long size)
+{
+	if (!size)
+		return 0;
+
+	l1d_inval_range(addr, size);
+	andes_l2c_inval_range(addr, size);
+
+	return 0;
+}
+
+uintptr_t mcall_dcache_wbinval_range(unsigned long addr, unsigned long size)
+{
+	if (!size)
+		return 0;
+
+	l1d_wbinval_range(addr, size);
+	andes_l2c_wbinval_range(addr, size);
+
+	return 0;
+}
+
 uintptr_t mcall_l1_cache_i_prefetch_op(unsigned long enable)
 {
 	if (enable) {
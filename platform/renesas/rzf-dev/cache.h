@@ -14,6 +14,10 @@ uintptr_t mcall_set_mmisc_ctl(unsigned long input);
 uintptr_t mcall_icache_op(unsigned int enable);
 uintptr_t mcall_dcache_op(unsigned int enable);
 uintptr_t mcall_dcache_wbinval_all(void);
+uintptr_t mcall_dcache_wb_range(unsigned long addr, unsigned long size);
+uintptr_t mcall_dcache_inval_range(unsigned long addr, unsigned long size);
+uintptr_t mcall_dcache_wbinval_range(unsigned long addr, unsigned long size);
+void cache_range_init(void);
 uintptr_t mcall_l1_cache_i_prefetch_op(unsigned long enable);
 uintptr_t mcall_l1_cache_d_prefetch_op(unsigned long enable);
 uintptr_t mcall_non_blocking_load_store(unsigned long enable);
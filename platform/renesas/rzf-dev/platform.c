@@ -15,9 +15,13 @@
 #include <sbi/sbi_console.h>
 #include <sbi/sbi_const.h>
 #include <sbi/sbi_domain.h>
+#include <sbi/sbi_error.h>
 #include <sbi/sbi_ipi.h>
 #include <sbi/sbi_platform.h>
 #include <sbi/sbi_trap.h>
+#include <sbi_utils/cache/andes_l2c.h>
+#include <sbi_utils/cache/fdt_cache.h>
+#include <sbi_utils/fdt/fdt_edit.h>
 #include <sbi_utils/fdt/fdt_fixup.h>
 #include <sbi_utils/irqchip/plic.h>
 #include <sbi_utils/serial/uart8250.h>
@@ -33,6 +37,11 @@ static struct plic_data plic = {
 	.num_src = RZF_PLIC_NUM_SOURCES,
 };
 
+static struct andes_l2c_data l2c = {
+	.addr = RZF_L2C_ADDR,
+	.line_size = RZF_L2C_LINE_SIZE,
+};
+
 static void sbi_clear_mmiscctl_msa(void)
 {
 	unsigned long mmisc_ctl;
@@ -62,6 +71,7 @@ static void rzf_disable_cache(void)
 static int rzf_final_init(bool cold_boot)
 {
 	void *fdt;
+	bool edit;
 
 	/* enable L1 cache */
 	uintptr_t mcache_ctl_val = csr_read(CSR_MCACHECTL);
@@ -85,19 +95,25 @@ static int rzf_final_init(bool cold_boot)
 		mmisc_ctl_val |= V5_MMISC_CTL_NON_BLOCKING_EN;
 	csr_write(CSR_MMISCCTL, mmisc_ctl_val);
 
-	/* enable L2 cache */
-	uint32_t *l2c_ctl_base = (void *)RZF_L2C_ADDR + V5_L2C_CTL_OFFSET;
-	uint32_t l2c_ctl_val = *l2c_ctl_base;
-
-	if (!(l2c_ctl_val & V5_L2C_CTL_ENABLE_MASK))
-		l2c_ctl_val |= V5_L2C_CTL_ENABLE_MASK;
-	*l2c_ctl_base = l2c_ctl_val;
-
 	if (!cold_boot)
 		return 0;
 
+	/*
+	 * enable L2 cache, configured from the DT node if there is one
+	 * and with the reset configuration otherwise
+	 */
+	if (fdt_cache_init())
+		andes_l2c_init(&l2c);
+
+	cache_range_init();
+
 	fdt = sbi_scratch_thishart_arg1_ptr();
+
+	/* Batch the fixups and redo them one by one if the batch fails */
+	edit = !fdt_edit_begin(fdt);
 	fdt_fixups(fdt);
+	if (edit && fdt_edit_commit(fdt))
+		fdt_fixups(fdt);
 
 	init_pma();
 	return 0;
@@ -156,11 +172,26 @@ static int rzf_timer_init(bool cold_boot)
 	return plmt_warm_timer_init();
 }
 
+/* Check that the caller may access the whole range of a cache operation */
+static bool rzf_cache_range_allowed(unsigned long addr, unsigned long size)
+{
+	ulong smode = (csr_read(CSR_MSTATUS) & MSTATUS_MPP) >>
+			MSTATUS_MPP_SHIFT;
+
+	if (!size)
+		return TRUE;
+
+	return sbi_domain_check_addr_range(sbi_domain_thishart_ptr(), addr,
+					   size, smode,
+					   SBI_DOMAIN_READ | SBI_DOMAIN_WRITE);
+}
+
 /* Vendor-Specific SBI handler */
 static int rzf_vendor_ext_provider(long extid, long funcid,
 	const struct sbi_trap_regs *regs, unsigned long *out_value,
 	struct sbi_trap_info *out_trap)
 {
+	u64 hpm_val = 0;
 	int ret = 0;
 	switch (funcid) {
 	case SBI_EXT_ANDES_GET_MCACHE_CTL_STATUS:
@@ -224,6 +255,27 @@ static int rzf_vendor_ext_provider(long extid, long funcid,
 		rzf_disable_cache();
 		*out_value = 0;
 		break;
+	case SBI_EXT_ANDES_DCACHE_WB_RANGE:
+	case SBI_EXT_ANDES_DCACHE_INVAL_RANGE:
+	case SBI_EXT_ANDES_DCACHE_WBINVAL_RANGE:
+		if (!rzf_cache_range_allowed(regs->a0, regs->a1)) {
+			ret = SBI_EINVALID_ADDR;
+			break;
+		}
+		if (funcid == SBI_EXT_ANDES_DCACHE_WB_RANGE)
+			ret = mcall_dcache_wb_range(regs->a0, regs->a1);
+		else if (funcid == SBI_EXT_ANDES_DCACHE_INVAL_RANGE)
+			ret = mcall_dcache_inval_range(regs->a0, regs->a1);
+		else
+			ret = mcall_dcache_wbinval_range(regs->a0, regs->a1);
+		break;
+	case SBI_EXT_ANDES_L2C_SET_PREFETCH:
+		ret = andes_l2c_set_prefetch(regs->a0, regs->a1);
+		break;
+	case SBI_EXT_ANDES_L2C_HPM_READ:
+		ret = andes_l2c_hpm_read(regs->a0, &hpm_val);
+		*out_value = hpm_val;
+		break;
 	default:
 		sbi_printf("Unsupported vendor sbi call : %ld\n", funcid);
 		asm volatile("ebreak");
@@ -23,6 +23,7 @@
 #define RZF_PLMT_ADDR			0x110c0000
 
 #define RZF_L2C_ADDR			0x13400000
+#define RZF_L2C_LINE_SIZE		64
 
 #define RZF_SCIF_ADDR			0x1004B800
 #define RZF_SCIF_FREQUENCY		100000000
@@ -76,6 +77,15 @@ enum sbi_ext_andes_fid {
 	SBI_EXT_ANDES_GET_MISA_CTL_STATUS,
 	SBI_EXT_ANDES_ENABLE_CACHE,
 	SBI_EXT_ANDES_DISABLE_CACHE,
+
+	// cache maintenance by physical address range (addr, size).
+	SBI_EXT_ANDES_DCACHE_WB_RANGE,
+	SBI_EXT_ANDES_DCACHE_INVAL_RANGE,
+	SBI_EXT_ANDES_DCACHE_WBINVAL_RANGE,
+
+	// L2 cache controller tuning and performance counters.
+	SBI_EXT_ANDES_L2C_SET_PREFETCH,
+	SBI_EXT_ANDES_L2C_HPM_READ,
 };
 
 /* nds v5 mmisc_ctl register*/
@@ -112,9 +122,24 @@ enum sbi_ext_andes_fid {
 #define V5_MCACHE_CTL_CCTL_SUEN_OFFSET  8
 
 /*nds cctl command*/
+#define V5_UCCTL_L1D_VA_INVAL 0
+#define V5_UCCTL_L1D_VA_WB 1
+#define V5_UCCTL_L1D_VA_WBINVAL 2
 #define V5_UCCTL_L1D_WBINVAL_ALL 6
 #define V5_UCCTL_L1D_WB_ALL 7
 
+/* nds mdcm_cfg register */
+#define V5_MDCM_CFG_DSET_OFFSET   0
+#define V5_MDCM_CFG_DWAY_OFFSET   3
+#define V5_MDCM_CFG_DSZ_OFFSET    6
+#define V5_MDCM_CFG_DSET_MASK     (7UL << V5_MDCM_CFG_DSET_OFFSET)
+#define V5_MDCM_CFG_DWAY_MASK     (7UL << V5_MDCM_CFG_DWAY_OFFSET)
+#define V5_MDCM_CFG_DSZ_MASK      (7UL << V5_MDCM_CFG_DSZ_OFFSET)
+
+/* nds mmsc_cfg register */
+#define V5_MMSC_CFG_VCCTL_OFFSET  18
+#define V5_MMSC_CFG_VCCTL_MASK    (3UL << V5_MMSC_CFG_VCCTL_OFFSET)
+
 #define V5_MCACHE_CTL_IC_EN     (1UL << V5_MCACHE_CTL_IC_EN_OFFSET)
 #define V5_MCACHE_CTL_DC_EN     (1UL << V5_MCACHE_CTL_DC_EN_OFFSET)
 #define V5_MCACHE_CTL_IC_RWECC  (1UL << V5_MCACHE_CTL_IC_RWECC_OFFSET)
@@ -127,22 +152,4 @@ enum sbi_ext_andes_fid {
 	| V5_MCACHE_CTL_L1D_PREFETCH_EN | V5_MCACHE_CTL_DC_WAROUND_1_EN \
 	| V5_MCACHE_CTL_DC_WAROUND_2_EN)
 
-#define V5_L2C_CTL_OFFSET           0x8
-#define V5_L2C_CTL_ENABLE_OFFSET    0
-#define V5_L2C_CTL_IPFDPT_OFFSET    3
-#define V5_L2C_CTL_DPFDPT_OFFSET    5
-#define V5_L2C_CTL_TRAMOCTL_OFFSET  8
-#define V5_L2C_CTL_TRAMICTL_OFFSET  10
-#define V5_L2C_CTL_DRAMOCTL_OFFSET  11
-#define V5_L2C_CTL_DRAMICTL_OFFSET  13
-
-#define V5_L2C_CTL_ENABLE_MASK      (1UL << V5_L2C_CTL_ENABLE_OFFSET)
-#define V5_L2C_CTL_IPFDPT_MASK      (3UL << V5_L2C_CTL_IPFDPT_OFFSET)
-#define V5_L2C_CTL_DPFDPT_MASK      (3UL << V5_L2C_CTL_DPFDPT_OFFSET)
-#define V5_L2C_CTL_TRAMOCTL_MASK    (3UL << V5_L2C_CTL_TRAMOCTL_OFFSET)
-#define V5_L2C_CTL_TRAMICTL_MASK    (1UL << V5_L2C_CTL_TRAMICTL_OFFSET)
-#define V5_L2C_CTL_DRAMOCTL_MASK    (3UL << V5_L2C_CTL_DRAMOCTL_OFFSET)
-#define V5_L2C_CTL_DRAMICTL_MASK    (1UL << V5_L2C_CTL_DRAMICTL_OFFSET)
-
-
 #endif /* _RZF_PLATFORM_H_ */
@@ -0,0 +1,326 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * domain_interval_fuzz.c - Check domain address intervals against a linear scan
+ *
+ * Random sets of overlapping memory regions get an address interval
+ * table built by domain_build_intervals(). sbi_domain_check_addr() and
+ * sbi_domain_check_addr_range(), which look up the table through
+ * domain_find_interval(), are compared with the linear scan of the
+ * regions used before the table existed. Region boundaries and random
+ * addresses are checked for every mode and access type. The per-HART
+ * cache of the last interval hit is enabled so cached lookups are
+ * checked as well.
+ */
+
+#include <sbi/riscv_asm.h>
+
+/* sbi_domain.c finds the HART and its scratch space through CSRs */
+#undef csr_read
+#define csr_read(csr)	fuzz_csr_read(csr)
+static unsigned long fuzz_csr_read(unsigned long csr);
+
+#include "../../lib/sbi/sbi_domain.c"
+#include "host.h"
+
+#define FUZZ_SEED		0x5eed
+#define FUZZ_SETS		20000
+#define FUZZ_REGIONS_MAX	16
+#define FUZZ_RANDOM_ADDRS	32
+#define FUZZ_RANGES		64
+
+/* Most regions are placed in a small window so that they overlap */
+#define FUZZ_WINDOW_ORDER	24
+
+static unsigned long fuzz_scratch[512] __aligned(4096);
+
+static unsigned long fuzz_csr_read(unsigned long csr)
+{
+	return (csr == CSR_MSCRATCH) ? (unsigned long)fuzz_scratch : 0;
+}
+
+/* Symbols of sbi_domain.c not needed by the interval lookup */
+int sbi_printf(const char *format, ...)
+{
+	return 0;
+}
+
+unsigned long sbi_scratch_alloc_offset(unsigned long size)
+{
+	return 0;
+}
+
+u32 sbi_platform_hart_index(const struct sbi_platform *plat, u32 hartid)
+{
+	return -1U;
+}
+
+int sbi_hart_pmp_image_build(struct sbi_scratch *scratch,
+			     struct sbi_domain *dom)
+{
+	return 0;
+}
+
+int sbi_hsm_hart_start(struct sbi_scratch *scratch,
+		       const struct sbi_domain *dom,
+		       u32 hartid, ulong saddr, ulong smode, ulong priv)
+{
+	return SBI_ENOTSUPP;
+}
+
+static struct sbi_domain_memregion fuzz_regions[FUZZ_REGIONS_MAX + 1];
+static struct sbi_domain fuzz_dom = {
+	.name = "fuzz",
+	.regions = fuzz_regions,
+};
+static unsigned long fuzz_checks;
+
+/* sbi_domain_check_addr() as it was before the interval table */
+static bool fuzz_check_addr_linear(const struct sbi_domain *dom,
+				   unsigned long addr, unsigned long mode,
+				   unsigned long access_flags)
+{
+	bool mmio = FALSE;
+	struct sbi_domain_memregion *reg;
+	unsigned long rstart, rend, rflags, rwx = 0, rrwx = 0;
+
+	if (access_flags & SBI_DOMAIN_READ)
+		rwx |= SBI_DOMAIN_MEMREGION_M_READABLE;
+	if (access_flags & SBI_DOMAIN_WRITE)
+		rwx |= SBI_DOMAIN_MEMREGION_M_WRITABLE;
+	if (access_flags & SBI_DOMAIN_EXECUTE)
+		rwx |= SBI_DOMAIN_MEMREGION_M_EXECUTABLE;
+	if (access_flags & SBI_DOMAIN_MMIO)
+		mmio = TRUE;
+
+	sbi_domain_for_each_memregion(dom, reg) {
+		rflags = reg->flags;
+		rrwx = (mode == PRV_M ?
+			(rflags & SBI_DOMAIN_MEMREGION_M_ACCESS_MASK) :
+			(rflags & SBI_DOMAIN_MEMREGION_SU_ACCESS_MASK)
+			>> SBI_DOMAIN_MEMREGION_SU_ACCESS_SHIFT);
+
+		rstart = reg->base;
+		rend = (reg->order < __riscv_xlen) ?
+			rstart + ((1UL << reg->order) - 1) : -1UL;
+		if (rstart <= addr && addr <= rend) {
+			if ((mmio && !(rflags & SBI_DOMAIN_MEMREGION_MMIO)) ||
+			    (!mmio && (rflags & SBI_DOMAIN_MEMREGION_MMIO)))
+				return FALSE;
+			return ((rrwx & rwx) == rwx) ? TRUE : FALSE;
+		}
+	}
+
+	return (mode == PRV_M) ? TRUE : FALSE;
+}
+
+/* Access only changes at region boundaries so check those in the range */
+static bool fuzz_check_range_linear(const struct sbi_domain *dom,
+				    unsigned long addr, unsigned long size,
+				    unsigned long mode,
+				    unsigned long access_flags)
+{
+	unsigned long end = addr + size - 1, bound;
+	struct sbi_domain_memregion *reg;
+
+	if (!size || end < addr)
+		return FALSE;
+	if (!fuzz_check_addr_linear(dom, addr, mode, access_flags))
+		return FALSE;
+
+	sbi_domain_for_each_memregion(dom, reg) {
+		bound = reg->base;
+		if (addr < bound && bound <= end &&
+		    !fuzz_check_addr_linear(dom, bound, mode, access_flags))
+			return FALSE;
+		bound = domain_memregion_end(reg);
+		if (bound == -1UL)
+			continue;
+		bound++;
+		if (addr < bound && bound <= end &&
+		    !fuzz_check_addr_linear(dom, bound, mode, access_flags))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void fuzz_gen_regions(void)
+{
+	unsigned long order, base, flags;
+	u32 i, count = 1 + host_rand() % FUZZ_REGIONS_MAX;
+
+	for (i = 0; i < count; i++) {
+		switch (host_rand() % 8) {
+		case 0:
+			/* Anywhere in the address space */
+			order = 3 + host_rand() % (__riscv_xlen - 2);
+			base = host_rand() << 1;
+			break;
+		case 1:
+			/* At the top of the address space */
+			order = 3 + host_rand() % (__riscv_xlen - 2);
+			base = -1UL;
+			break;
+		default:
+			order = 3 + host_rand() % (FUZZ_WINDOW_ORDER - 2);
+			base = host_rand() % (1UL << FUZZ_WINDOW_ORDER);
+			break;
+		}
+		if (order < __riscv_xlen)
+			base &= ~((1UL << order) - 1);
+		else
+			base = 0;
+
+		flags = host_rand() & (SBI_DOMAIN_MEMREGION_ACCESS_MASK |
+				       SBI_DOMAIN_MEMREGION_MMIO);
+		fuzz_regions[i].base = base;
+		fuzz_regions[i].order = order;
+		fuzz_regions[i].flags = flags;
+	}
+	fuzz_regions[count].order = 0;
+}
+
+static void fuzz_print_regions(void)
+{
+	struct sbi_domain_memregion *reg;
+
+	sbi_domain_for_each_memregion(&fuzz_dom, reg)
+		host_printf("  region base 0x%lx order %lu flags 0x%lx\n",
+			    reg->base, reg->order, reg->flags);
+}
+
+static int fuzz_addr(unsigned long addr)
+{
+	unsigned long mode, flags;
+	bool got, want;
+	int pass;
+
+	/* The second pass hits the cached interval of the first */
+	for (pass = 0; pass < 2; pass++) {
+		for (mode = PRV_S; mode <= PRV_M; mode += PRV_M - PRV_S) {
+			for (flags = 0; flags < 16; flags++) {
+				got = sbi_domain_check_addr(&fuzz_dom, addr,
+							    mode, flags);
+				want = fuzz_check_addr_linear(&fuzz_dom, addr,
+							      mode, flags);
+				fuzz_checks++;
+				if (got == want)
+					continue;
+				host_printf("check_addr 0x%lx mode %lu flags "
+					    "0x%lx: got %d want %d\n", addr,
+					    mode, flags, got, want);
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static int fuzz_range(unsigned long addr, unsigned long size)
+{
+	unsigned long mode, flags;
+	bool got, want;
+
+	for (mode = PRV_S; mode <= PRV_M; mode += PRV_M - PRV_S) {
+		for (flags = 0; flags < 16; flags++) {
+			got = sbi_domain_check_addr_range(&fuzz_dom, addr, size,
+							  mode, flags);
+			want = fuzz_check_range_linear(&fuzz_dom, addr, size,
+						       mode, flags);
+			fuzz_checks++;
+			if (got == want)
+				continue;
+			host_printf("check_addr_range 0x%lx size 0x%lx mode "
+				    "%lu flags 0x%lx: got %d want %d\n", addr,
+				    size, mode, flags, got, want);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static unsigned long fuzz_pick_addr(void)
+{
+	struct sbi_domain_memregion *reg;
+	u32 count = 0;
+
+	sbi_domain_for_each_memregion(&fuzz_dom, reg)
+		count++;
+	reg = &fuzz_regions[host_rand() % count];
+
+	switch (host_rand() % 4) {
+	case 0:
+		return host_rand() % (1UL << FUZZ_WINDOW_ORDER);
+	case 1:
+		return reg->base + host_rand() % 3 - 1;
+	case 2:
+		return domain_memregion_end(reg) + host_rand() % 3 - 1;
+	default:
+		return host_rand() << 1;
+	}
+}
+
+static int fuzz_set(void)
+{
+	struct sbi_domain_memregion *reg;
+	unsigned long end;
+	int i;
+
+	fuzz_gen_regions();
+
+	/* Every set gets a fresh interval pool and HART cache */
+	domain_intervals_used = 0;
+	sbi_memset(fuzz_scratch, 0, sizeof(fuzz_scratch));
+	domain_build_intervals(&fuzz_dom);
+	if (!fuzz_dom.interval_count) {
+		host_printf("no address intervals built\n");
+		return -1;
+	}
+
+	if (fuzz_addr(0) || fuzz_addr(-1UL))
+		return -1;
+	sbi_domain_for_each_memregion(&fuzz_dom, reg) {
+		end = domain_memregion_end(reg);
+		if (fuzz_addr(reg->base - 1) || fuzz_addr(reg->base) ||
+		    fuzz_addr(end) || fuzz_addr(end + 1))
+			return -1;
+	}
+	for (i = 0; i < FUZZ_RANDOM_ADDRS; i++) {
+		if (fuzz_addr(fuzz_pick_addr()))
+			return -1;
+	}
+
+	for (i = 0; i < FUZZ_RANGES; i++) {
+		if (fuzz_range(fuzz_pick_addr(),
+			       1 + host_rand() % (1UL << (host_rand() % 32))))
+			return -1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	int i;
+
+	host_srand(FUZZ_SEED);
+
+	/* Cache of the last interval hit right after struct sbi_scratch */
+	domain_addr_cache_off = sizeof(struct sbi_scratch);
+
+	for (i = 0; i < FUZZ_SETS; i++) {
+		if (fuzz_set()) {
+			host_printf("mismatch in region set %d:\n", i);
+			fuzz_print_regions();
+			return 1;
+		}
+	}
+
+	host_printf("%d region sets, %lu checks, no mismatch\n",
+		    FUZZ_SETS, fuzz_checks);
+
+	return 0;
+}
@@ -0,0 +1,251 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * fdt_edit_bench.c - Check and measure the batched FDT edit session
+ *
+ * A synthetic device tree with one CPU node per HART and many device
+ * nodes gets the same edits as the CPU and domain boot fixups: the
+ * "opensbi-domain" property of every CPU node is removed and every
+ * other device node is disabled. The edits are done once with plain
+ * libfdt calls and once with an edit session. Both results are checked
+ * and the time of each is printed. The larger trees need more edits
+ * than the session queue holds, which checks fdt_edit_run().
+ */
+
+#include <libfdt.h>
+#include <sbi/sbi_string.h>
+#include <sbi_utils/fdt/fdt_edit.h>
+#include "host.h"
+
+#define BENCH_CPUS		8
+#define BENCH_ROUNDS		8
+#define BENCH_MAX_DEVICES	4096
+#define BENCH_PHANDLE_BASE	0x100
+#define BENCH_BLOB_SIZE		(1024 * 1024)
+
+/* The FDT index of fdt_helper.c is not part of this program */
+void fdt_index_invalidate(void)
+{
+}
+
+static char bench_blob[BENCH_BLOB_SIZE];
+static char bench_work[BENCH_BLOB_SIZE];
+
+/*
+ * Phandle lookup table rebuilt with one walk whenever the structure
+ * block changes, like the FDT index used by the fixups.
+ */
+static struct {
+	const void *fdt;
+	u32 size_dt_struct;
+	int offsets[BENCH_MAX_DEVICES];
+} bench_index;
+
+static int bench_node_by_phandle(void *fdt, u32 phandle)
+{
+	int noff;
+	u32 ph;
+
+	if (bench_index.fdt != fdt ||
+	    bench_index.size_dt_struct != fdt_size_dt_struct(fdt)) {
+		for (noff = fdt_next_node(fdt, -1, NULL); noff >= 0;
+		     noff = fdt_next_node(fdt, noff, NULL)) {
+			ph = fdt_get_phandle(fdt, noff);
+			if (BENCH_PHANDLE_BASE <= ph &&
+			    ph < BENCH_PHANDLE_BASE + BENCH_MAX_DEVICES)
+				bench_index.offsets[ph - BENCH_PHANDLE_BASE] =
+									noff;
+		}
+		bench_index.fdt = fdt;
+		bench_index.size_dt_struct = fdt_size_dt_struct(fdt);
+	}
+
+	return bench_index.offsets[phandle - BENCH_PHANDLE_BASE];
+}
+
+static int bench_build(int devices)
+{
+	char name[32];
+	int i, err = 0;
+	void *fdt = bench_blob;
+
+	err |= fdt_create(fdt, BENCH_BLOB_SIZE);
+	err |= fdt_finish_reservemap(fdt);
+	err |= fdt_begin_node(fdt, "");
+	err |= fdt_property_u32(fdt, "#address-cells", 2);
+	err |= fdt_property_u32(fdt, "#size-cells", 2);
+
+	err |= fdt_begin_node(fdt, "cpus");
+	for (i = 0; i < BENCH_CPUS; i++) {
+		sbi_memset(name, 0, sizeof(name));
+		sbi_strcpy(name, "cpu@0");
+		name[4] += i;
+		err |= fdt_begin_node(fdt, name);
+		err |= fdt_property_string(fdt, "device_type", "cpu");
+		err |= fdt_property_u32(fdt, "reg", i);
+		err |= fdt_property_string(fdt, "status", "okay");
+		err |= fdt_property_string(fdt, "opensbi-domain", "domain0");
+		err |= fdt_end_node(fdt);
+	}
+	err |= fdt_end_node(fdt);
+
+	err |= fdt_begin_node(fdt, "soc");
+	for (i = 0; i < devices; i++) {
+		sbi_memset(name, 0, sizeof(name));
+		sbi_strcpy(name, "dev@00000");
+		name[4] += (i / 10000) % 10;
+		name[5] += (i / 1000) % 10;
+		name[6] += (i / 100) % 10;
+		name[7] += (i / 10) % 10;
+		name[8] += i % 10;
+		err |= fdt_begin_node(fdt, name);
+		err |= fdt_property_string(fdt, "compatible", "vendor,dev");
+		err |= fdt_property_u64(fdt, "reg", 0x10000000UL + i * 0x1000);
+		err |= fdt_property_u32(fdt, "phandle", BENCH_PHANDLE_BASE + i);
+		err |= fdt_property_string(fdt, "status", "okay");
+		err |= fdt_end_node(fdt);
+	}
+	err |= fdt_end_node(fdt);
+
+	err |= fdt_end_node(fdt);
+	err |= fdt_finish(fdt);
+	if (err)
+		return -FDT_ERR_INTERNAL;
+
+	return fdt_pack(fdt);
+}
+
+struct bench_priv {
+	int devices;
+};
+
+/* Same edits as the CPU and domain fixups, see fdt_domain_fixup() */
+static int bench_pass(void *fdt, void *p)
+{
+	struct bench_priv *priv = p;
+	int i, err, off, cpus;
+
+	cpus = fdt_path_offset(fdt, "/cpus");
+	if (cpus < 0)
+		return cpus;
+	fdt_for_each_subnode(off, fdt, cpus) {
+		if (!fdt_getprop(fdt, off, "opensbi-domain", NULL))
+			continue;
+		err = fdt_edit_nop_property(fdt, off, "opensbi-domain");
+		if (err < 0)
+			return err;
+	}
+
+	for (i = 0; i < priv->devices; i += 2) {
+		off = bench_node_by_phandle(fdt, BENCH_PHANDLE_BASE + i);
+		err = fdt_edit_disable_node(fdt, off);
+		if (err < 0)
+			return err;
+	}
+
+	return 0;
+}
+
+static int bench_verify(void *fdt, int devices)
+{
+	const char *status, *compat;
+	int i, off, cpus, len;
+
+	if (fdt_check_full(fdt, fdt_totalsize(fdt)))
+		return -1;
+
+	cpus = fdt_path_offset(fdt, "/cpus");
+	fdt_for_each_subnode(off, fdt, cpus) {
+		if (fdt_getprop(fdt, off, "opensbi-domain", NULL))
+			return -1;
+	}
+
+	for (i = 0; i < devices; i++) {
+		off = fdt_node_offset_by_phandle(fdt, BENCH_PHANDLE_BASE + i);
+		if (off < 0)
+			return -1;
+		status = fdt_getprop(fdt, off, "status", &len);
+		if (!status ||
+		    sbi_strcmp(status, (i & 1) ? "okay" : "disabled"))
+			return -1;
+		compat = fdt_getprop(fdt, off, "compatible", &len);
+		if (!compat || sbi_strcmp(compat, "vendor,dev"))
+			return -1;
+	}
+
+	return 0;
+}
+
+/* Returns the best time in ns out of BENCH_ROUNDS or 0 on failure */
+static unsigned long long bench_run(int devices, bool session)
+{
+	struct bench_priv priv = { .devices = devices };
+	unsigned long long start, best = 0, t;
+	int round, err;
+	void *fdt = bench_work;
+
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		sbi_memcpy(fdt, bench_blob, fdt_totalsize(bench_blob));
+		bench_index.fdt = NULL;
+
+		start = host_time_ns();
+		if (session) {
+			err = fdt_edit_begin(fdt);
+			if (!err)
+				err = fdt_edit_run(fdt, bench_pass, &priv);
+			if (!err)
+				err = fdt_edit_commit(fdt);
+		} else {
+			/* Same growth as the fixups do without a session */
+			err = fdt_open_into(fdt, fdt, fdt_totalsize(fdt) +
+					    32 + devices * 32);
+			if (!err)
+				err = bench_pass(fdt, &priv);
+		}
+		t = host_time_ns() - start;
+
+		if (err) {
+			host_printf("%s edit failed: %d\n",
+				    session ? "session" : "libfdt", err);
+			return 0;
+		}
+		if (bench_verify(fdt, devices)) {
+			host_printf("%s edit result is wrong\n",
+				    session ? "session" : "libfdt");
+			return 0;
+		}
+		if (!best || t < best)
+			best = t;
+	}
+
+	return best;
+}
+
+int main(void)
+{
+	static const int devices[] = { 16, 64, 256, 1024, 4096 };
+	unsigned long long plain, batched;
+	int i, err;
+
+	host_printf("%8s %8s %12s %12s %8s\n", "devices", "edits",
+		    "libfdt(us)", "session(us)", "speedup");
+	for (i = 0; i < (int)array_size(devices); i++) {
+		err = bench_build(devices[i]);
+		if (err) {
+			host_printf("failed to build device tree: %d\n", err);
+			return 1;
+		}
+
+		plain = bench_run(devices[i], false);
+		batched = bench_run(devices[i], true);
+		if (!plain || !batched)
+			return 1;
+
+		host_printf("%8d %8d %12llu %12llu %7llu.%llux\n", devices[i],
+			    BENCH_CPUS + (devices[i] + 1) / 2, plain / 1000,
+			    batched / 1000, plain / batched,
+			    (plain * 10 / batched) % 10);
+	}
+
+	return 0;
+}
@@ -0,0 +1,64 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * host.c - Host C library services for host programs
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "host.h"
+
+void host_printf(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+	fflush(stdout);
+}
+
+unsigned long long host_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static unsigned long long host_rand_state = 1;
+
+void host_srand(unsigned long seed)
+{
+	host_rand_state = seed ? seed : 1;
+}
+
+unsigned long host_rand(void)
+{
+	/* xorshift64* */
+	host_rand_state ^= host_rand_state >> 12;
+	host_rand_state ^= host_rand_state << 25;
+	host_rand_state ^= host_rand_state >> 27;
+
+	return (host_rand_state * 0x2545F4914F6CDD1DULL) >> 1;
+}
+
+void *host_malloc(unsigned long size)
+{
+	void *ptr = malloc(size);
+
+	if (!ptr) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	return ptr;
+}
+
+void host_free(void *ptr)
+{
+	free(ptr);
+}
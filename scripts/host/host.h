@@ -0,0 +1,27 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * host.h - Host C library services for host programs
+ *
+ * Host programs build OpenSBI library sources with the OpenSBI headers
+ * (-nostdinc) so they cannot include C library headers. The few host
+ * services they need are provided by host.c through this header.
+ */
+
+#ifndef __HOST_H__
+#define __HOST_H__
+
+void host_printf(const char *fmt, ...)
+	__attribute__((format(printf, 1, 2)));
+
+/* Monotonic time in nanoseconds */
+unsigned long long host_time_ns(void);
+
+/* Seed and draw from a deterministic pseudo random number generator */
+void host_srand(unsigned long seed);
+unsigned long host_rand(void);
+
+void *host_malloc(unsigned long size);
+void host_free(void *ptr);
+
+#endif
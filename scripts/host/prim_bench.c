@@ -0,0 +1,338 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * prim_bench.c - Check and measure the Zbb variant of core primitives
+ *
+ * The string functions of sbi_string.c, the set bit walk of
+ * sbi_bitops.c used for HART masks and the FDT byte swapping of
+ * libfdt_env.h are built for the default ISA and with __riscv_zbb (see
+ * prim_ops.c). Both variants are checked for equal results on many
+ * inputs and then timed on the same inputs.
+ *
+ * The host runs its own equivalents of ctz, clz and rev8, while orc.b is
+ * emulated. The numbers show the gain of the Zbb code paths, but not the
+ * exact gain on a RISC-V HART. The bench payload measures that on the
+ * target with a default and a Zbb build.
+ */
+
+#include <libfdt.h>
+#include <sbi/sbi_bitops.h>
+#include <sbi/sbi_string.h>
+#include "host.h"
+#include "prim_ops.h"
+
+#define PRIM_SEED		0x2bb
+#define PRIM_ROUNDS		16
+#define PRIM_STR_MAX		320
+#define PRIM_MASK_BITS		256
+#define PRIM_MASK_WORDS		(PRIM_MASK_BITS / BITS_PER_LONG)
+#define PRIM_FDT_CPUS		64
+#define PRIM_FDT_DEVICES	1024
+#define PRIM_FDT_SIZE		(256 * 1024)
+
+static const struct prim_ops *prim_variants[] = {
+	&prim_generic_ops,
+	&prim_zbb_ops,
+};
+
+static char prim_str_a[PRIM_STR_MAX + 16] __aligned(8);
+static char prim_str_b[PRIM_STR_MAX + 16] __aligned(8);
+static unsigned long prim_mask[PRIM_MASK_WORDS];
+static char prim_fdt[PRIM_FDT_SIZE] __aligned(8);
+static volatile unsigned long prim_sink;
+
+/* Fill str with len non-NUL characters, a NUL and then garbage */
+static void prim_fill_str(char *str, unsigned long len)
+{
+	unsigned long i;
+
+	for (i = 0; i < len; i++)
+		str[i] = 1 + host_rand() % 255;
+	str[len] = '\0';
+	for (i = len + 1; i < len + 9; i++)
+		str[i] = host_rand();
+}
+
+static int prim_sign(int val)
+{
+	return (val > 0) - (val < 0);
+}
+
+static int prim_check_strings(void)
+{
+	unsigned long off, len, pos, count, v;
+	const char *a, *b;
+	int want, got;
+
+	for (off = 0; off < 8; off++) {
+		for (len = 0; len < PRIM_STR_MAX - 8; len++) {
+			prim_fill_str(prim_str_a + off, len);
+			for (v = 0; v < array_size(prim_variants); v++) {
+				if (prim_variants[v]->str_len(prim_str_a + off) ==
+				    len)
+					continue;
+				host_printf("%s strlen off %lu len %lu wrong\n",
+					    prim_variants[v]->name, off, len);
+				return -1;
+			}
+		}
+	}
+
+	for (len = 0; len < 100000; len++) {
+		/* Mostly aligned pairs so that the word loop is taken */
+		off = (len & 3) ? 0 : host_rand() % 8;
+		a = prim_str_a + off;
+		b = prim_str_b + ((len & 7) ? off : host_rand() % 8);
+		count = host_rand() % PRIM_STR_MAX;
+		prim_fill_str((char *)a, host_rand() % (PRIM_STR_MAX - 8));
+		sbi_memcpy((char *)b, a, sbi_strlen(a) + 1);
+		if (host_rand() & 1) {
+			pos = host_rand() % (sbi_strlen(a) + 1);
+			((char *)b)[pos] = host_rand();
+		}
+
+		/* Same char signedness as sbi_strncmp() */
+		want = 0;
+		for (pos = 0; pos < count; pos++) {
+			want = prim_sign(a[pos] - b[pos]);
+			if (want || !a[pos])
+				break;
+		}
+		for (v = 0; v < array_size(prim_variants); v++) {
+			got = prim_sign(prim_variants[v]->str_ncmp(a, b, count));
+			if (got == want)
+				continue;
+			host_printf("%s strncmp count %lu: got %d want %d\n",
+				    prim_variants[v]->name, count, got, want);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void prim_fill_mask(unsigned long set)
+{
+	unsigned long i;
+
+	sbi_memset(prim_mask, 0, sizeof(prim_mask));
+	for (i = 0; i < set; i++) {
+		if (set == PRIM_MASK_BITS)
+			prim_mask[i / BITS_PER_LONG] |= 1UL << (i % BITS_PER_LONG);
+		else
+			prim_mask[(host_rand() % PRIM_MASK_BITS) / BITS_PER_LONG] |=
+				1UL << (host_rand() % BITS_PER_LONG);
+	}
+}
+
+static int prim_check_masks(void)
+{
+	unsigned long i, bit, bits, want, v;
+
+	for (i = 0; i < 20000; i++) {
+		prim_fill_mask(host_rand() % (PRIM_MASK_BITS + 1));
+		bits = 1 + host_rand() % PRIM_MASK_BITS;
+
+		want = 0;
+		for (bit = 0; bit < bits; bit++) {
+			if (prim_mask[bit / BITS_PER_LONG] &
+			    (1UL << (bit % BITS_PER_LONG)))
+				want += bit;
+		}
+		for (v = 0; v < array_size(prim_variants); v++) {
+			if (prim_variants[v]->mask_walk(prim_mask, bits) == want)
+				continue;
+			host_printf("%s mask walk of %lu bits wrong\n",
+				    prim_variants[v]->name, bits);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void prim_node_name(char *name, const char *prefix, int num)
+{
+	char digits[12];
+	int len = 0;
+
+	/* sbi_strcpy() does not copy the NUL */
+	sbi_memset(name, 0, 16);
+	sbi_strcpy(name, prefix);
+	name += sbi_strlen(name);
+	do {
+		digits[len++] = '0' + num % 10;
+		num /= 10;
+	} while (num);
+	while (len)
+		*name++ = digits[--len];
+	*name = '\0';
+}
+
+static int prim_build_fdt(void)
+{
+	void *fdt = prim_fdt;
+	char name[32];
+	int i, err = 0;
+
+	err |= fdt_create(fdt, PRIM_FDT_SIZE);
+	err |= fdt_finish_reservemap(fdt);
+	err |= fdt_begin_node(fdt, "");
+	err |= fdt_property_u32(fdt, "#address-cells", 2);
+	err |= fdt_property_u32(fdt, "#size-cells", 2);
+
+	err |= fdt_begin_node(fdt, "cpus");
+	for (i = 0; i < PRIM_FDT_CPUS; i++) {
+		prim_node_name(name, "cpu@", i);
+		err |= fdt_begin_node(fdt, name);
+		err |= fdt_property_string(fdt, "device_type", "cpu");
+		err |= fdt_property_u32(fdt, "reg", i);
+		err |= fdt_property_string(fdt, "riscv,isa", "rv64imafdc_zbb");
+		err |= fdt_property_string(fdt, "status", "okay");
+		err |= fdt_end_node(fdt);
+	}
+	err |= fdt_end_node(fdt);
+
+	err |= fdt_begin_node(fdt, "soc");
+	for (i = 0; i < PRIM_FDT_DEVICES; i++) {
+		prim_node_name(name, "device@", 0x10000000 + i * 0x1000);
+		err |= fdt_begin_node(fdt, name);
+		err |= fdt_property_string(fdt, "compatible", "vendor,device");
+		err |= fdt_property_u64(fdt, "reg", 0x10000000UL + i * 0x1000);
+		err |= fdt_property_u32(fdt, "interrupts", i);
+		err |= fdt_property_u32(fdt, "phandle", 0x100 + i);
+		err |= fdt_end_node(fdt);
+	}
+	err |= fdt_end_node(fdt);
+
+	err |= fdt_end_node(fdt);
+	err |= fdt_finish(fdt);
+	if (err || fdt_check_full(fdt, fdt_totalsize(fdt)))
+		return -1;
+
+	return 0;
+}
+
+static int prim_check_fdt(void)
+{
+	if (prim_build_fdt()) {
+		host_printf("failed to build device tree\n");
+		return -1;
+	}
+
+	if (prim_generic_ops.fdt_walk(prim_fdt) !=
+	    prim_zbb_ops.fdt_walk(prim_fdt)) {
+		host_printf("fdt walks differ\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+struct prim_cmp {
+	const char *a;
+	const char *b;
+	unsigned long count;
+};
+
+static unsigned long prim_run_strlen(const struct prim_ops *ops,
+				     const void *arg)
+{
+	return ops->str_len(arg);
+}
+
+static unsigned long prim_run_strncmp(const struct prim_ops *ops,
+				      const void *arg)
+{
+	const struct prim_cmp *cmp = arg;
+
+	return ops->str_ncmp(cmp->a, cmp->b, cmp->count);
+}
+
+static unsigned long prim_run_mask(const struct prim_ops *ops,
+				   const void *arg)
+{
+	return ops->mask_walk(arg, PRIM_MASK_BITS);
+}
+
+static unsigned long prim_run_fdt(const struct prim_ops *ops,
+				  const void *arg)
+{
+	return ops->fdt_walk(arg);
+}
+
+/* Returns the best time in ps per call out of PRIM_ROUNDS */
+static unsigned long long prim_time(const struct prim_ops *ops,
+				    unsigned long (*run)(const struct prim_ops *,
+							 const void *),
+				    const void *arg, unsigned long iters)
+{
+	unsigned long long start, t, best = 0;
+	unsigned long i, sum;
+	int round;
+
+	for (round = 0; round < PRIM_ROUNDS; round++) {
+		sum = 0;
+		start = host_time_ns();
+		for (i = 0; i < iters; i++)
+			sum += run(ops, arg);
+		t = (host_time_ns() - start) * 1000 / iters;
+		prim_sink += sum;
+		if (!best || t < best)
+			best = t;
+	}
+
+	return best;
+}
+
+static void prim_row(const char *name,
+		     unsigned long (*run)(const struct prim_ops *, const void *),
+		     const void *arg, unsigned long iters)
+{
+	unsigned long long generic, zbb;
+
+	generic = prim_time(&prim_generic_ops, run, arg, iters);
+	zbb = prim_time(&prim_zbb_ops, run, arg, iters);
+	if (!zbb)
+		zbb = 1;
+
+	host_printf("%-30s %9llu.%llu %9llu.%llu %6llu.%02llux\n", name,
+		    generic / 1000, (generic / 100) % 10, zbb / 1000,
+		    (zbb / 100) % 10, generic / zbb, (generic * 100 / zbb) % 100);
+}
+
+int main(void)
+{
+	struct prim_cmp cmp;
+
+	host_srand(PRIM_SEED);
+	if (prim_check_strings() || prim_check_masks() || prim_check_fdt())
+		return 1;
+
+	host_printf("%-30s %11s %11s %9s\n", "operation", "generic(ns)",
+		    "zbb(ns)", "speedup");
+
+	prim_fill_str(prim_str_a, 16);
+	prim_row("strlen 16 bytes", prim_run_strlen, prim_str_a, 1000000);
+	prim_fill_str(prim_str_a, 256);
+	prim_row("strlen 256 bytes", prim_run_strlen, prim_str_a, 100000);
+	prim_row("strlen 253 bytes, unaligned", prim_run_strlen,
+		 prim_str_a + 3, 100000);
+
+	sbi_memcpy(prim_str_b, prim_str_a, 257);
+	cmp.a = prim_str_a;
+	cmp.b = prim_str_b;
+	cmp.count = PRIM_STR_MAX;
+	prim_row("strncmp 256 bytes, equal", prim_run_strncmp, &cmp, 100000);
+
+	prim_fill_mask(8);
+	prim_row("hartmask walk, 8 of 256 set", prim_run_mask, prim_mask,
+		 1000000);
+	prim_fill_mask(PRIM_MASK_BITS);
+	prim_row("hartmask walk, 256 of 256 set", prim_run_mask, prim_mask,
+		 10000);
+
+	prim_row("fdt walk, 1088 nodes", prim_run_fdt, prim_fdt, 200);
+
+	return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * prim_ops.c - Core primitives of one build variant for prim_bench
+ *
+ * This file is built twice: once for the default ISA and once with
+ * PRIM_ZBB, which defines __riscv_zbb like the compiler does for a Zbb
+ * PLATFORM_RISCV_ISA. That selects the Zbb versions of sbi_bitops.h,
+ * sbi_string.c and libfdt_env.h. The library sources are included with
+ * their functions renamed so that both variants link into one program.
+ */
+
+#ifdef PRIM_ZBB
+#define __riscv_zbb		1
+#define PRIM(name)		zbb_##name
+#define PRIM_OPS		prim_zbb_ops
+#else
+#define PRIM(name)		generic_##name
+#define PRIM_OPS		prim_generic_ops
+#endif
+
+#define find_first_bit		PRIM(find_first_bit)
+#define find_first_zero_bit	PRIM(find_first_zero_bit)
+#define find_last_bit		PRIM(find_last_bit)
+#define find_next_bit		PRIM(find_next_bit)
+#define find_next_zero_bit	PRIM(find_next_zero_bit)
+
+#define sbi_strcmp		PRIM(sbi_strcmp)
+#define sbi_strncmp		PRIM(sbi_strncmp)
+#define sbi_strlen		PRIM(sbi_strlen)
+#define sbi_strnlen		PRIM(sbi_strnlen)
+#define sbi_strcpy		PRIM(sbi_strcpy)
+#define sbi_strncpy		PRIM(sbi_strncpy)
+#define sbi_strchr		PRIM(sbi_strchr)
+#define sbi_strrchr		PRIM(sbi_strrchr)
+#define sbi_memset		PRIM(sbi_memset)
+#define sbi_memcpy		PRIM(sbi_memcpy)
+#define sbi_memmove		PRIM(sbi_memmove)
+#define sbi_memcmp		PRIM(sbi_memcmp)
+#define sbi_memchr		PRIM(sbi_memchr)
+
+#include <sbi/sbi_bitops.h>
+#include <sbi/sbi_string.h>
+#include <libfdt_env.h>
+#include <fdt.h>
+#include "prim_ops.h"
+
+#ifdef PRIM_ZBB
+/*
+ * Hosts have no orc.b so the inline assembly of orc_b() in sbi_string.c
+ * is replaced by an emulation. It takes a few instructions instead of
+ * one, so the host understates the gain of the Zbb string functions.
+ */
+static inline unsigned long host_orc_b(unsigned long word)
+{
+	unsigned long low7 = 0x7f7f7f7f7f7f7f7fUL;
+	unsigned long nonzero = ((word & low7) + low7) | word;
+
+	return ((nonzero & ~low7) >> 7) * 0xff;
+}
+
+#define __asm__(...)		(ret = host_orc_b(word))
+#endif
+
+#include "../../lib/sbi/sbi_string.c"
+
+#undef __asm__
+
+#include "../../lib/sbi/sbi_bitops.c"
+
+static unsigned long prim_mask_walk(const unsigned long *mask,
+				    unsigned long bits)
+{
+	unsigned long bit, sum = 0;
+
+	for_each_set_bit(bit, mask, bits)
+		sum += bit;
+
+	return sum;
+}
+
+/* Decode every token of the structure block like fdt_next_tag() does */
+static unsigned long prim_fdt_walk(const void *fdt)
+{
+	const struct fdt_header *hdr = fdt;
+	const fdt32_t *p, *end;
+	unsigned long sum = 0;
+	u32 i, len;
+
+	p = fdt + fdt32_to_cpu(hdr->off_dt_struct);
+	end = (const void *)p + fdt32_to_cpu(hdr->size_dt_struct);
+	while (p < end) {
+		switch (fdt32_to_cpu(*p++)) {
+		case FDT_BEGIN_NODE:
+			len = sbi_strlen((const char *)p) + 1;
+			sum += len;
+			p += (len + 3) / 4;
+			break;
+		case FDT_PROP:
+			len = fdt32_to_cpu(p[0]);
+			sum += fdt32_to_cpu(p[1]);
+			p += 2;
+			for (i = 0; i < len / 4; i++)
+				sum += fdt32_to_cpu(p[i]);
+			p += (len + 3) / 4;
+			break;
+		case FDT_END:
+			return sum;
+		default:
+			break;
+		}
+	}
+
+	return sum;
+}
+
+const struct prim_ops PRIM_OPS = {
+#ifdef PRIM_ZBB
+	.name = "zbb",
+#else
+	.name = "generic",
+#endif
+	.str_len = sbi_strlen,
+	.str_ncmp = sbi_strncmp,
+	.mask_walk = prim_mask_walk,
+	.fdt_walk = prim_fdt_walk,
+};
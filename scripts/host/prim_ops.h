@@ -0,0 +1,27 @@
+/*
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * prim_ops.h - Core primitives of one build variant for prim_bench
+ */
+
+#ifndef __PRIM_OPS_H__
+#define __PRIM_OPS_H__
+
+#include <sbi/sbi_types.h>
+
+struct prim_ops {
+	const char *name;
+	size_t (*str_len)(const char *str);
+	int (*str_ncmp)(const char *a, const char *b, size_t count);
+	/* Sum of the set bit indexes walked with for_each_set_bit() */
+	unsigned long (*mask_walk)(const unsigned long *mask,
+				   unsigned long bits);
+	/* Checksum of every cell decoded from the FDT structure block */
+	unsigned long (*fdt_walk)(const void *fdt);
+};
+
+/* Built from prim_ops.c for the default ISA and with __riscv_zbb */
+extern const struct prim_ops prim_generic_ops;
+extern const struct prim_ops prim_zbb_ops;
+
+#endif